@@ -0,0 +1,26 @@
+var pitft = require("../pitft-napi");
+
+// Run several of these next to server.js, each one draws a bouncing ball on its own surface
+var client = pitft.connect("/tmp/pitft.sock");
+
+var xMax = client.size().width;
+var yMax = client.size().height;
+
+var x = Math.random() * xMax, y = Math.random() * yMax;
+var dx = 3, dy = 2;
+var r = Math.random(), g = Math.random(), b = Math.random();
+
+client.z(process.pid % 10); // Higher z is drawn on top
+
+setInterval(function () {
+    x += dx;
+    y += dy;
+
+    if (x < 10 || x > xMax - 10) dx = -dx;
+    if (y < 10 || y > yMax - 10) dy = -dy;
+
+    client.clear();
+    client.color(r, g, b);
+    client.circle(x, y, 10);
+    client.commit(); // The server shows the new frame at its next present
+}, 20);
@@ -0,0 +1,37 @@
+var pitft = require("../pitft-napi");
+
+// A PiTFT and the HDMI display, each rasterized and blitted on its own native thread
+var tft = pitft("/dev/fb1", true, { threaded: true });
+var hdmi = pitft("/dev/fb0", true, { threaded: true });
+
+// Hold 25 fps on the PiTFT by trading away antialiasing when the Pi is busy
+tft.qualityGovernor(25, function (level) {
+    console.log("PiTFT quality level " + level);
+});
+
+var draw = function (fb, t) {
+    var xMax = fb.size().width;
+    var yMax = fb.size().height;
+
+    fb.clear();
+
+    for (var n = 0; n < 20; n++) {
+        var a = t / 1000 + n / 20 * 2 * Math.PI;
+
+        fb.color(0.5 + Math.sin(a) / 2, 0.5 + Math.cos(a) / 2, n / 20);
+        fb.circle(xMax / 2 + Math.sin(a) * xMax / 3, yMax / 2 + Math.cos(a) * yMax / 3, yMax / 10);
+    }
+
+    fb.font("fantasy", 24);
+    fb.color(1, 1, 1);
+    fb.text(xMax / 2, yMax / 2, new Date().toLocaleTimeString(), true); // Font faces are shared by both displays
+};
+
+setInterval(function () {
+    var t = Date.now();
+
+    draw(tft, t);
+    draw(hdmi, t);
+
+    pitft.blitSync([tft, hdmi]); // Both panels rasterize in parallel and present together
+}, 40);
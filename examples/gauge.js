@@ -0,0 +1,44 @@
+var pitft = require("../pitft-napi");
+
+var fb = pitft("/dev/fb1", true); // Returns a framebuffer in double buffering mode
+
+var xMax = fb.size().width;
+var yMax = fb.size().height;
+
+var radius = yMax / 2 - 10;
+
+// The static dial goes to the back buffer once
+fb.clear();
+fb.color(1, 1, 1);
+fb.circle(xMax / 2, yMax / 2, radius, false, 4);
+
+for (var a = -135; a <= 135; a += 27) {
+    var r = a / (180 / Math.PI);
+
+    fb.line(xMax / 2 + Math.sin(r) * radius * 0.85, yMax / 2 - Math.cos(r) * radius * 0.85,
+        xMax / 2 + Math.sin(r) * radius * 0.95, yMax / 2 - Math.cos(r) * radius * 0.95, 3);
+}
+
+// The needle is a layer, it is drawn over the back buffer by the native animation timer
+var needle = fb.layerCreate("line", {
+    x: xMax / 2,
+    y: yMax / 2,
+    length: radius * 0.8,
+    lineWidth: 4,
+    rotation: -135,
+    r: 1, g: 0, b: 0
+});
+
+fb.blit();
+
+var sweep = function () {
+    var value = Math.random() * 270 - 135;
+
+    // One call per sweep, no JS runs while the needle moves
+    fb.animate(needle, "rotation", null, value, 800, "easeOutBack", function (completed) {
+        if (completed)
+            setTimeout(sweep, 500);
+    });
+};
+
+sweep();
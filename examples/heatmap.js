@@ -0,0 +1,51 @@
+var pitft = require("../pitft-napi");
+var threads = require("worker_threads");
+
+var WORKERS = 4;
+
+if (threads.isMainThread) {
+    var fb = pitft("/dev/fb1", true);
+    var shared = fb.sharedBuffer(); // The back buffer, now a SharedArrayBuffer
+    var workers = [];
+
+    for (var i = 0; i < WORKERS; i++)
+        workers.push(new threads.Worker(__filename, { workerData: { shared: shared, part: i } }));
+
+    var frame = function () {
+        var number = pitft.beginFrame(shared, WORKERS);
+
+        workers.forEach(function (worker) {
+            worker.postMessage(number);
+        });
+
+        pitft.frameDone(shared).then(function () {
+            fb.blit(); // Every band is written, present it
+            setTimeout(frame, 20);
+        });
+    };
+
+    frame();
+} else {
+    var shared = threads.workerData.shared;
+    var pixels = pitft.sharedPixels(shared);
+    var pitch = shared.stride / 2;
+
+    // Each worker renders its own band of rows
+    var y0 = Math.floor(shared.height * threads.workerData.part / WORKERS);
+    var y1 = Math.floor(shared.height * (threads.workerData.part + 1) / WORKERS);
+
+    threads.parentPort.on("message", function (number) {
+        var t = number / 20;
+
+        for (var y = y0; y < y1; y++) {
+            for (var x = 0; x < shared.width; x++) {
+                var v = (Math.sin(x / 17 + t) + Math.sin(y / 13 - t) + Math.sin((x + y) / 23 + t / 2) + 3) / 6;
+
+                // RGB565, blue to red
+                pixels[y * pitch + x] = (Math.round(v * 31) << 11) | (Math.round((1 - Math.abs(v * 2 - 1)) * 63) << 5) | Math.round((1 - v) * 31);
+            }
+        }
+
+        pitft.endPart(shared);
+    });
+}
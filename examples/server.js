@@ -0,0 +1,23 @@
+var pitft = require("../pitft-napi");
+
+// Owns the PiTFT and draws a background, other processes draw on top through client.js
+var fb = pitft("/dev/fb1", true);
+
+var xMax = fb.size().width;
+var yMax = fb.size().height;
+
+fb.clear();
+fb.color(0, 0, 0.3);
+fb.fill();
+fb.blit();
+
+fb.serverStart("/tmp/pitft.sock");
+
+setInterval(function () {
+    fb.color(0, 0, 0.3);
+    fb.rect(0, yMax - 20, xMax, 20);
+    fb.color(1, 1, 1);
+    fb.font("fantasy", 12);
+    fb.text(4, yMax - 6, fb.serverClients() + " clients");
+    fb.blit();
+}, 1000);
@@ -0,0 +1,26 @@
+var pitft = require("../pitft-napi");
+
+// Fonts and images are loaded on a background thread while the splash screen is up
+var fb = pitft("/dev/fb1", true, {
+    preload: {
+        fonts: [{ name: "fantasy", size: 24 }, { name: "fantasy", size: 12, bold: true }],
+        images: ["raspberry-pi.png", "raspberry-pi-icon.png"]
+    }
+});
+
+var xMax = fb.size().width;
+var yMax = fb.size().height;
+
+fb.clear();
+fb.color(0.2, 0.2, 0.2);
+fb.rect(xMax / 4, yMax / 2 - 2, xMax / 2, 4); // Plain shapes need nothing from the preload
+fb.blit();
+
+fb.ready().then(function () {
+    fb.clear();
+    fb.image(xMax / 2 - 16, yMax / 2 - 48, "raspberry-pi-icon.png"); // Already decoded
+    fb.font("fantasy", 24);
+    fb.color(1, 1, 1);
+    fb.text(xMax / 2, yMax / 2 + 20, "Ready", true);
+    fb.blit();
+});
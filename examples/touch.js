@@ -0,0 +1,59 @@
+var pitft = require("../pitft-napi");
+
+var fb = pitft("/dev/fb1", true); // Returns a framebuffer in double buffering mode
+
+var xMax = fb.size().width;
+var yMax = fb.size().height;
+
+var buttons = [
+    { x: 10, y: 10, w: xMax / 2 - 15, h: yMax - 20, r: 1, g: 0, b: 0 },
+    { x: xMax / 2 + 5, y: 10, w: xMax / 2 - 15, h: yMax - 20, r: 0, g: 0, b: 1 }
+];
+
+var draw = function (pressed) {
+    fb.clear();
+
+    buttons.forEach(function (button, id) {
+        var dim = id === pressed ? 0.5 : 1;
+
+        fb.color(button.r * dim, button.g * dim, button.b * dim);
+        fb.rect(button.x, button.y, button.w, button.h);
+    });
+
+    fb.blit();
+};
+
+// The touchscreen is read on a native thread, the callback only sees presses, releases and real moves.
+// Pass a recorded stream (e.g. "cat /dev/input/event0 > touches.bin") instead of the device to replay it. A file
+// has no axis range to query, so the raw range of the recording device (here a 12-bit controller) is given too.
+var replay = process.argv[2];
+var options = {
+    width: xMax,
+    height: yMax,
+    rotate: 90,
+    debounce: 30
+};
+
+if (replay) {
+    options.minX = 0;
+    options.maxX = 4095;
+    options.minY = 0;
+    options.maxY = 4095;
+}
+
+var ts = pitft.touchscreen(replay || "/dev/input/touchscreen", options, function (event) {
+    if (event.type === "down")
+        draw(event.region);
+    else if (event.type === "up") {
+        draw(null);
+
+        if (event.region !== null && event.region === event.pressRegion)
+            console.log("button " + event.region + " tapped at " + event.x + "," + event.y);
+    }
+});
+
+buttons.forEach(function (button, id) {
+    ts.addRegion(id, button.x, button.y, button.w, button.h);
+});
+
+draw(null);
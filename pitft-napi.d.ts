@@ -9,10 +9,209 @@ declare module "pitft" {
    * Creates a new PiTFT instance.
    * @param  {string}            device          The framebuffer device. (e.g. /dev/fb1)
    * @param  {boolean}           doubleBuffering True if you want to use double buffering.
+   * @param  {FrameBufferOptions} options        (optional) Further options.
    */
-  function pitft (device: string, doubleBuffering?: boolean): pitft.FrameBuffer;
+  function pitft (device: string, doubleBuffering?: boolean, options?: pitft.FrameBufferOptions): pitft.FrameBuffer;
 
   namespace pitft {
+    interface FrameBufferOptions {
+      /**
+       * true to rasterize and blit on a native thread of this display. Draw calls are recorded
+       * and run on that thread when blit() or flush() is called, so several displays render in
+       * parallel. Errors from recorded calls are thrown by the next blit() or flush().
+       */
+      threaded?: boolean;
+
+      /**
+       * Renders the back buffer at this fraction of the screen resolution (e.g. 0.5) and stretches
+       * it to the screen on blit(), to save memory. Drawing still uses screen coordinates; layers
+       * and render server clients stay at full resolution. Requires double buffering.
+       */
+      scale?: number;
+
+      /**
+       * Fonts and images to load on a background thread right after the framebuffer opens, so the
+       * first text() and image() calls do not pay for fontconfig and PNG decoding. Draws that need
+       * an item still loading wait for it. fb.ready() tells when everything is loaded.
+       */
+      preload?: {
+        fonts?: { name: string, size?: number, bold?: boolean }[];
+        images?: string[];
+      };
+    }
+
+    /**
+     * Blits several framebuffers together. Threaded framebuffers rasterize their frames in
+     * parallel and present them at the same time.
+     * @param {FrameBuffer[]} frameBuffers The framebuffers.
+     */
+    function blitSync (frameBuffers: FrameBuffer[]): void;
+
+    /**
+     * Drops the font and image caches shared by all framebuffers, e.g. to release memory. Image files
+     * changed on disk are reloaded without it, and the image cache keeps at most 8 MB of decoded pixels.
+     */
+    function clearCaches (): void;
+
+    /**
+     * Opens a touchscreen input device. Events are decoded on a native thread and only
+     * presses, releases and moves of at least moveThreshold pixels reach the callback.
+     * Keep a reference to the returned object for as long as events are wanted.
+     * @param  {string}             device   The input device (e.g. /dev/input/event0), a recorded event file or a pipe.
+     *                                       Files and pipes need minX, maxX, minY and maxY in the options.
+     * @param  {TouchScreenOptions} options  (optional) Calibration, orientation and filtering.
+     * @param  {Function}           callback Called with every delivered event.
+     */
+    function touchscreen (device: string, options: TouchScreenOptions, callback: (event: TouchEvent) => void): TouchScreen;
+    function touchscreen (device: string, callback: (event: TouchEvent) => void): TouchScreen;
+
+    /**
+     * Writes an asset pack of pre-converted RGB565 bitmaps (plus an 8-bit alpha plane where needed)
+     * for fb.assetPack(). Usually run offline with tools/pack-assets.js.
+     * @param {string}                  output  Path of the pack file.
+     * @param {object|string[]}         images  { name: pngPath } or a list of PNG paths named by themselves.
+     * @param {object}                  options (optional) rle: true to run-length encode images where it is smaller.
+     */
+    function packAssets (output: string, images: { [name: string]: string } | string[], options?: { rle?: boolean }): void;
+
+    /**
+     * Connects to a render server started with fb.serverStart() in another process. Draw calls
+     * are copied into a shared memory ring and drawn by the server onto this client's own surface,
+     * which appears on screen at commit().
+     * @param  {string}       socketPath The server's socket path.
+     * @return {RenderClient}            The connection.
+     */
+    function connect (socketPath: string): RenderClient;
+
+    interface SharedBuffer {
+      /** The back buffer, RGB565 rows of stride bytes. */
+      buffer: SharedArrayBuffer;
+
+      /** [0] parts still drawing the current frame, [1] frame number. */
+      sync: Int32Array;
+      width: number;
+      height: number;
+      stride: number;
+      format: "rgb565";
+    }
+
+    /** Returns a Uint16Array over the shared back buffer, one element per pixel. */
+    function sharedPixels (handle: SharedBuffer): Uint16Array;
+
+    /**
+     * Starts a frame drawn by parts workers and returns its frame number.
+     * @param {SharedBuffer} handle The handle from fb.sharedBuffer().
+     * @param {number}       parts  Number of endPart() calls that complete the frame.
+     */
+    function beginFrame (handle: SharedBuffer, parts: number): number;
+
+    /** Called by a worker when its part of the frame is written. */
+    function endPart (handle: SharedBuffer): void;
+
+    /** Resolves once every part of the frame has ended, without blocking the event loop. */
+    function frameDone (handle: SharedBuffer): Promise<void>;
+
+    interface RenderClient {
+      /** Size of the server's display. */
+      size (): { width: number, height: number };
+
+      /** Clears the client surface to transparent. */
+      clear (): void;
+
+      /** Sets the drawing color, alpha defaults to 1. */
+      color (r: number, g: number, b: number, alpha?: number): void;
+
+      /** Fills the whole client surface with the current color. */
+      fill (): void;
+
+      rect (x: number, y: number, w: number, h: number, filled?: boolean, lineWidth?: number): void;
+      line (x0: number, y0: number, x1: number, y1: number, lineWidth?: number): void;
+      circle (x: number, y: number, radius: number, filled?: boolean, lineWidth?: number): void;
+      font (fontName: string, fontSize?: number, bold?: boolean): void;
+      text (x: number, y: number, text: string, centered?: boolean): void;
+
+      /**
+       * Copies a block of pixels onto the client surface, bypassing cairo.
+       * @param {Buffer} data   Rows of width pixels, tightly packed.
+       * @param {string} format (optional) "rgb565" (default, opaque) or "argb32" (cairo's premultiplied native order).
+       */
+      pixels (x: number, y: number, width: number, height: number, data: Buffer | Uint8Array | Uint16Array | Uint32Array, format?: "rgb565" | "argb32"): void;
+
+      /** Stacking order against other clients, higher is on top. Defaults to 0. */
+      z (order: number): void;
+
+      /** Shows everything drawn so far. The server presents at most once per frame. */
+      commit (): void;
+
+      /** Disconnects, the client's surface disappears from the screen. */
+      close (): void;
+    }
+
+    interface TouchScreenOptions {
+      /** Raw axis range, read from the device when omitted. Required when replaying a recorded file or pipe. */
+      minX?: number;
+      maxX?: number;
+      minY?: number;
+      maxY?: number;
+
+      /** Display size in pixels, usually fb.size().width and fb.size().height. */
+      width?: number;
+      height?: number;
+
+      /** Display rotation in degrees (0, 90, 180 or 270). */
+      rotate?: number;
+      swapXY?: boolean;
+      invertX?: boolean;
+      invertY?: boolean;
+
+      /** Releases followed by a new contact within this many milliseconds are ignored. Defaults to 20. */
+      debounce?: number;
+
+      /** Minimum movement in pixels before a move event is delivered. Defaults to 2. */
+      moveThreshold?: number;
+
+      /** true to drop events that neither start nor end inside a region. */
+      regionsOnly?: boolean;
+    }
+
+    interface TouchEvent {
+      type: "down" | "move" | "up";
+      x: number;
+      y: number;
+
+      /** Topmost region under the point, or null. */
+      region: number | null;
+
+      /** Region the touch started in, or null. */
+      pressRegion: number | null;
+
+      /** Event time in milliseconds. */
+      time: number;
+    }
+
+    interface TouchScreen {
+      /**
+       * Registers a rectangle for hit-testing. Regions added later are on top.
+       * Adding an existing id replaces it.
+       */
+      addRegion (id: number, x: number, y: number, width: number, height: number): void;
+
+      /**
+       * Removes a region.
+       */
+      removeRegion (id: number): void;
+
+      /**
+       * Removes all regions.
+       */
+      clearRegions (): void;
+
+      /**
+       * Stops the reader thread and releases the callback.
+       */
+      close (): void;
+    }
+
     interface FrameBuffer {
 
       /**
@@ -46,6 +245,11 @@ declare module "pitft" {
        */
       blit (): void;
 
+      /**
+       * Waits until a threaded framebuffer has drawn everything recorded so far, without presenting it.
+       */
+      flush (): void;
+
       /**
        * Selects a pattern for the next drawings.
        * @param {number} patternID ID of the pattern.
@@ -184,6 +388,147 @@ declare module "pitft" {
        * @param {string} path Path to the image file.
        */
       image (x: number, y: number, path: string): void;
+
+      /**
+       * Reports the memory used, in bytes: the mapped screen, the back buffer (sharedBackBuffer
+       * tells whether it lives in a SharedArrayBuffer), the copy of it shown by the last blit (0 until
+       * a layer or render server needs it), decoded images shared by all framebuffers, and the asset
+       * packs mapped by this one.
+       */
+      memory (): { screen: number, backBuffer: number, sharedBackBuffer: boolean, presented: number, imageCache: number,
+                   assetPacks: number };
+
+      /**
+       * Resolves when the fonts and images of the preload option are loaded, right away without one.
+       * Rejects with the first item that failed to load, the others are loaded anyway.
+       */
+      ready (): Promise<void>;
+
+      /**
+       * Moves the back buffer into a SharedArrayBuffer and returns a handle that can be posted to
+       * worker threads, which write pixels directly and report with pitft.endPart(). Blit once
+       * pitft.frameDone() resolves. Later calls return the same handle. Requires double buffering;
+       * a threaded framebuffer should be flushed before workers write.
+       * @return {SharedBuffer} The handle.
+       */
+      sharedBuffer (): SharedBuffer;
+
+      /**
+       * Memory maps an asset pack and returns the names it contains. image() calls with one of these
+       * names draw straight from the mapping without decoding. Packs loaded later take precedence.
+       * @param  {string}   path Path to the asset pack.
+       * @return {string[]}      The image names in the pack.
+       */
+      assetPack (path: string): string[];
+
+      /**
+       * Creates a layer and returns its ID. Layers are drawn over the back buffer on every blit
+       * and can be animated without any JS work per frame. Requires double buffering.
+       * @param  {string}          type       "rect", "circle", "line", "text" or "image".
+       * @param  {LayerProperties} properties (optional) Initial properties.
+       * @return {number}                     The ID of the new layer.
+       */
+      layerCreate (type: "rect" | "circle" | "line" | "text" | "image", properties?: LayerProperties): number;
+
+      /**
+       * Changes layer properties. The affected area is redrawn immediately.
+       * @param {number}          layerID    ID of the layer.
+       * @param {LayerProperties} properties Properties to change.
+       */
+      layerSet (layerID: number, properties: LayerProperties): void;
+
+      /**
+       * Removes a layer and cancels its animations.
+       * @param {number} layerID ID of the layer.
+       */
+      layerDestroy (layerID: number): void;
+
+      /**
+       * Animates a numeric layer property, or "color" with [r, g, b] values, and returns the animation ID.
+       * A native timer advances the animation, redraws only the affected area and presents it.
+       * Starting an animation on a property that is already animating cancels the older one.
+       * @param  {number}   layerID  ID of the layer.
+       * @param  {string}   property Property name, e.g. "x", "rotation", "alpha" or "color".
+       * @param  {number}   from     Start value, null to start from the current value.
+       * @param  {number}   to       End value.
+       * @param  {number}   duration Duration in milliseconds.
+       * @param  {string}   easing   (optional) "linear", "easeIn", "easeOut", "easeInOut", "easeOutBack" or "easeOutBounce".
+       * @param  {Function} callback (optional) Called with true when the animation completes, false when it is cancelled.
+       * @return {number}            The ID of the animation.
+       */
+      animate (layerID: number, property: string, from: number | number[] | null, to: number | number[], duration: number, easing?: string, callback?: (completed: boolean) => void): number;
+      animate (layerID: number, property: string, from: number | number[] | null, to: number | number[], duration: number, callback?: (completed: boolean) => void): number;
+
+      /**
+       * Stops an animation.
+       * @param {number}  animationID ID of the animation.
+       * @param {boolean} jumpToEnd   (optional) true to apply the end value before stopping.
+       */
+      animationStop (animationID: number, jumpToEnd?: boolean): void;
+
+      /**
+       * Sets the rate of the animation timer. Defaults to 60.
+       * @param {number} fps Frames per second.
+       */
+      animationFrameRate (fps: number): void;
+
+      /**
+       * Watches the cost of each frame (drawing plus presenting) against the budget of targetFps
+       * and lowers the drawing quality while over budget, raising it again once there is headroom.
+       * Levels: 0 full quality, 1 coarser curve tolerance, 2 shapes without antialiasing (text keeps
+       * it), 3 gradients drawn as their first color stop.
+       * @param {number|false} targetFps Frame rate to hold, false to turn the governor off.
+       * @param {Function}     callback  (optional) Called from blit() with the new level when it changes.
+       */
+      qualityGovernor (targetFps: number | false, callback?: (level: number) => void): void;
+
+      /** The governor's current quality level, 0 is full quality. */
+      qualityLevel (): number;
+
+      /**
+       * Makes this framebuffer a render server for other processes on socketPath (see pitft.connect()).
+       * Client surfaces are composited over the back buffer by z order, and presented on a native
+       * thread at most fps times a second. Requires double buffering.
+       * @param {string} socketPath Path of the Unix socket to listen on.
+       * @param {object} options    (optional) fps: frame rate cap, defaults to 60.
+       */
+      serverStart (socketPath: string, options?: { fps?: number }): void;
+
+      /** Stops the render server and disconnects its clients. */
+      serverStop (): void;
+
+      /** Number of connected render clients. */
+      serverClients (): number;
+    }
+
+    interface LayerProperties {
+      x?: number;
+      y?: number;
+      width?: number;
+      height?: number;
+      radius?: number;
+
+      /** Length of a line layer. Lines point up at rotation 0. */
+      length?: number;
+
+      /** Rotation around (x, y) in degrees, clockwise. */
+      rotation?: number;
+      scale?: number;
+      r?: number;
+      g?: number;
+      b?: number;
+      alpha?: number;
+      lineWidth?: number;
+      filled?: boolean;
+      visible?: boolean;
+      text?: string;
+      font?: string;
+      fontSize?: number;
+      bold?: boolean;
+      centered?: boolean;
+
+      /** Image path of an image layer. */
+      path?: string;
     }
   }
 
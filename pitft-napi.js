@@ -1,7 +1,83 @@
 var bindings = require('bindings')('pitftnapi');
 
-function pitft(arg1, arg2) {
-    return new bindings.FrameBuffer(process.cwd(), arg1, arg2);
+function pitft(arg1, arg2, arg3) {
+    return new bindings.FrameBuffer(process.cwd(), arg1, arg2, arg3);
 }
 
+pitft.blitSync = function (frameBuffers) {
+    bindings.FrameBuffer.blitSync(frameBuffers);
+};
+
+pitft.clearCaches = function () {
+    bindings.FrameBuffer.clearCaches();
+};
+
+pitft.touchscreen = function (device, options, callback) {
+    if (typeof options === 'function') {
+        callback = options;
+        options = {};
+    }
+
+    return new bindings.TouchScreen(device, options || {}, callback);
+};
+
+pitft.packAssets = function (output, images, options) {
+    if (Array.isArray(images)) {
+        var named = {};
+
+        images.forEach(function (image) {
+            named[image] = image;
+        });
+
+        images = named;
+    }
+
+    bindings.packAssets(output, images, options || {});
+};
+
+pitft.connect = function (socketPath) {
+    return new bindings.RenderClient(socketPath);
+};
+
+// Shared back buffer helpers, for the handle returned by fb.sharedBuffer(). They only touch the
+// SharedArrayBuffers, so they work the same in worker threads.
+pitft.sharedPixels = function (handle) {
+    return new Uint16Array(handle.buffer);
+};
+
+pitft.beginFrame = function (handle, parts) {
+    Atomics.store(handle.sync, 0, parts);
+
+    return Atomics.add(handle.sync, 1, 1) + 1;
+};
+
+pitft.endPart = function (handle) {
+    if (Atomics.sub(handle.sync, 0, 1) === 1)
+        Atomics.notify(handle.sync, 0);
+};
+
+pitft.frameDone = function (handle) {
+    return new Promise(function (resolve) {
+        var check = function () {
+            var pending = Atomics.load(handle.sync, 0);
+
+            if (pending <= 0)
+                return resolve();
+
+            if (Atomics.waitAsync) {
+                var result = Atomics.waitAsync(handle.sync, 0, pending);
+
+                if (result.async)
+                    result.value.then(check);
+                else
+                    check();
+            } else {
+                setTimeout(check, 1);
+            }
+        };
+
+        check();
+    });
+};
+
 module.exports = pitft;
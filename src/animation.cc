@@ -0,0 +1,383 @@
+#include "animation.h"
+
+#include <math.h>
+
+Animator::Animator() { nextAnimation = 0; }
+
+size_t Animator::CreateLayer(LayerType type) {
+    Layer *layer = new Layer();
+
+    layer->type = type;
+    layer->visible = true;
+    layer->filled = true;
+    layer->centered = false;
+    layer->x = layer->y = 0;
+    layer->width = layer->height = 0;
+    layer->radius = 0;
+    layer->length = 0;
+    layer->rotation = 0;
+    layer->scale = 1;
+    layer->r = layer->g = layer->b = 1;
+    layer->alpha = 1;
+    layer->lineWidth = 1;
+    layer->fontName = "Sans";
+    layer->fontSize = 12;
+    layer->fontBold = false;
+    layer->image = nullptr;
+
+    for (size_t i = 0; i < this->layers.size(); i++) {
+        if (this->layers[i] == nullptr) {
+            this->layers[i] = layer;
+            return i;
+        }
+    }
+
+    this->layers.push_back(layer);
+
+    return this->layers.size() - 1;
+}
+
+Layer *Animator::GetLayer(size_t id) {
+    if (id >= this->layers.size())
+        return nullptr;
+
+    return this->layers[id];
+}
+
+void Animator::DestroyLayer(size_t id) {
+    Layer *layer = this->GetLayer(id);
+
+    if (layer == nullptr)
+        return;
+
+    for (size_t i = 0; i < this->animations.size();) {
+        if (this->animations[i].layer == id) {
+            this->finished.push_back(std::make_pair(this->animations[i].id, false));
+            this->animations.erase(this->animations.begin() + i);
+        } else
+            i++;
+    }
+
+    if (layer->image != nullptr)
+        cairo_surface_destroy(layer->image);
+
+    delete layer;
+    this->layers[id] = nullptr;
+
+    return;
+}
+
+size_t Animator::Start(size_t layerId, std::vector<double Layer::*> properties, std::vector<double> from,
+                       std::vector<double> to, double duration, Easing easing, double now) {
+    Layer *layer = this->GetLayer(layerId);
+
+    if (layer == nullptr)
+        throw std::runtime_error("Error animating layer, layer not exists");
+
+    // a property can only follow one animation, the newer one wins
+    for (size_t i = 0; i < this->animations.size();) {
+        bool overlaps = false;
+
+        if (this->animations[i].layer == layerId)
+            for (size_t p = 0; p < properties.size(); p++)
+                for (size_t q = 0; q < this->animations[i].properties.size(); q++)
+                    if (properties[p] == this->animations[i].properties[q])
+                        overlaps = true;
+
+        if (overlaps) {
+            this->finished.push_back(std::make_pair(this->animations[i].id, false));
+            this->animations.erase(this->animations.begin() + i);
+        } else
+            i++;
+    }
+
+    // NaN start values mean "from wherever the layer is now"
+    for (size_t p = 0; p < properties.size(); p++)
+        if (isnan(from[p]))
+            from[p] = layer->*properties[p];
+
+    Animation animation;
+    animation.id = this->nextAnimation++;
+    animation.layer = layerId;
+    animation.properties = properties;
+    animation.from = from;
+    animation.to = to;
+    animation.start = now;
+    animation.duration = duration;
+    animation.easing = easing;
+
+    this->animations.push_back(animation);
+
+    return animation.id;
+}
+
+void Animator::Stop(size_t id, bool jumpToEnd) {
+    for (size_t i = 0; i < this->animations.size(); i++) {
+        if (this->animations[i].id == id) {
+            if (jumpToEnd)
+                this->Apply(this->animations[i], 1);
+
+            this->finished.push_back(std::make_pair(id, false));
+            this->animations.erase(this->animations.begin() + i);
+            break;
+        }
+    }
+
+    return;
+}
+
+long Animator::LayerOf(size_t id) {
+    for (size_t i = 0; i < this->animations.size(); i++)
+        if (this->animations[i].id == id)
+            return this->animations[i].layer;
+
+    return -1;
+}
+
+bool Animator::Running() { return !this->animations.empty() || !this->finished.empty(); }
+
+void Animator::Step(cairo_t *cr, double now, DamageRect &damage) {
+    for (size_t i = 0; i < this->animations.size();) {
+        Animation &animation = this->animations[i];
+        double t = animation.duration > 0 ? (now - animation.start) / animation.duration : 1;
+
+        t = t < 0 ? 0 : (t > 1 ? 1 : t);
+
+        this->Bounds(cr, animation.layer, damage);
+        this->Apply(animation, t);
+        this->Bounds(cr, animation.layer, damage);
+
+        if (t >= 1) {
+            this->finished.push_back(std::make_pair(animation.id, true));
+            this->animations.erase(this->animations.begin() + i);
+        } else
+            i++;
+    }
+
+    return;
+}
+
+std::vector<std::pair<size_t, bool>> Animator::TakeFinished() {
+    std::vector<std::pair<size_t, bool>> done;
+
+    done.swap(this->finished);
+
+    return done;
+}
+
+void Animator::Apply(Animation &animation, double t) {
+    Layer *layer = this->GetLayer(animation.layer);
+    double k = Ease(animation.easing, t);
+
+    if (layer == nullptr)
+        return;
+
+    for (size_t p = 0; p < animation.properties.size(); p++)
+        layer->*animation.properties[p] = animation.from[p] + (animation.to[p] - animation.from[p]) * k;
+
+    return;
+}
+
+void Animator::Path(cairo_t *cr, Layer *layer) {
+    cairo_translate(cr, layer->x, layer->y);
+
+    if (layer->rotation != 0)
+        cairo_rotate(cr, layer->rotation / (180.0 / 3.141592654));
+
+    if (layer->scale != 1)
+        cairo_scale(cr, layer->scale, layer->scale);
+
+    switch (layer->type) {
+    case LAYER_RECT:
+        cairo_rectangle(cr, 0, 0, layer->width, layer->height);
+        break;
+    case LAYER_CIRCLE:
+        cairo_arc(cr, 0, 0, layer->radius, 0, 2 * 3.141592654);
+        break;
+    case LAYER_LINE:
+        cairo_move_to(cr, 0, 0);
+        cairo_line_to(cr, 0, -layer->length);
+        break;
+    case LAYER_TEXT:
+        cairo_select_font_face(cr, layer->fontName.c_str(), CAIRO_FONT_SLANT_NORMAL,
+                               layer->fontBold ? CAIRO_FONT_WEIGHT_BOLD : CAIRO_FONT_WEIGHT_NORMAL);
+        cairo_set_font_size(cr, layer->fontSize);
+
+        if (layer->centered) {
+            cairo_text_extents_t extents;
+            cairo_text_extents(cr, layer->text.c_str(), &extents);
+            cairo_move_to(cr, -extents.width / 2, extents.height / 2);
+        } else
+            cairo_move_to(cr, 0, 0);
+
+        cairo_text_path(cr, layer->text.c_str());
+        break;
+    case LAYER_IMAGE:
+        if (layer->image != nullptr)
+            cairo_rectangle(cr, 0, 0, cairo_image_surface_get_width(layer->image),
+                            cairo_image_surface_get_height(layer->image));
+        break;
+    }
+
+    return;
+}
+
+void Animator::Bounds(cairo_t *cr, size_t id, DamageRect &damage) {
+    Layer *layer = this->GetLayer(id);
+    double x0, y0, x1, y1;
+
+    if (layer == nullptr || !layer->visible)
+        return;
+
+    cairo_save(cr);
+    this->Path(cr, layer);
+
+    if (layer->type == LAYER_LINE || ((layer->type == LAYER_RECT || layer->type == LAYER_CIRCLE) && !layer->filled)) {
+        cairo_set_line_width(cr, layer->lineWidth);
+        cairo_stroke_extents(cr, &x0, &y0, &x1, &y1);
+    } else
+        cairo_fill_extents(cr, &x0, &y0, &x1, &y1);
+
+    // extents are in user space, the layer may be rotated
+    double xs[4] = {x0, x1, x1, x0};
+    double ys[4] = {y0, y0, y1, y1};
+
+    for (int i = 0; i < 4; i++) {
+        cairo_user_to_device(cr, &xs[i], &ys[i]);
+        // pad for antialiasing
+        Grow(damage, xs[i] - 2, ys[i] - 2, xs[i] + 2, ys[i] + 2);
+    }
+
+    cairo_new_path(cr);
+    cairo_restore(cr);
+
+    return;
+}
+
+void Animator::Paint(cairo_t *cr) {
+    for (size_t i = 0; i < this->layers.size(); i++) {
+        Layer *layer = this->layers[i];
+
+        if (layer == nullptr || !layer->visible)
+            continue;
+
+        cairo_save(cr);
+        this->Path(cr, layer);
+
+        if (layer->type == LAYER_IMAGE) {
+            if (layer->image != nullptr) {
+                cairo_clip(cr);
+                cairo_set_source_surface(cr, layer->image, 0, 0);
+                cairo_paint_with_alpha(cr, layer->alpha);
+            }
+        } else {
+            cairo_set_source_rgba(cr, layer->r, layer->g, layer->b, layer->alpha);
+
+            if (layer->type == LAYER_LINE ||
+                ((layer->type == LAYER_RECT || layer->type == LAYER_CIRCLE) && !layer->filled)) {
+                cairo_set_line_width(cr, layer->lineWidth);
+                cairo_stroke(cr);
+            } else
+                cairo_fill(cr);
+        }
+
+        cairo_restore(cr);
+    }
+
+    return;
+}
+
+double Animator::Ease(Easing easing, double t) {
+    double u;
+
+    switch (easing) {
+    case EASE_IN:
+        return t * t * t;
+    case EASE_OUT:
+        u = 1 - t;
+        return 1 - u * u * u;
+    case EASE_IN_OUT:
+        if (t < 0.5)
+            return 4 * t * t * t;
+        u = -2 * t + 2;
+        return 1 - u * u * u / 2;
+    case EASE_OUT_BACK:
+        u = t - 1;
+        return 1 + 2.70158 * u * u * u + 1.70158 * u * u;
+    case EASE_OUT_BOUNCE:
+        if (t < 1 / 2.75)
+            return 7.5625 * t * t;
+        if (t < 2 / 2.75) {
+            t -= 1.5 / 2.75;
+            return 7.5625 * t * t + 0.75;
+        }
+        if (t < 2.5 / 2.75) {
+            t -= 2.25 / 2.75;
+            return 7.5625 * t * t + 0.9375;
+        }
+        t -= 2.625 / 2.75;
+        return 7.5625 * t * t + 0.984375;
+    default:
+        return t;
+    }
+}
+
+double Layer::*Animator::Property(const std::string &name) {
+    if (name == "x")
+        return &Layer::x;
+    if (name == "y")
+        return &Layer::y;
+    if (name == "width")
+        return &Layer::width;
+    if (name == "height")
+        return &Layer::height;
+    if (name == "radius")
+        return &Layer::radius;
+    if (name == "length")
+        return &Layer::length;
+    if (name == "rotation")
+        return &Layer::rotation;
+    if (name == "scale")
+        return &Layer::scale;
+    if (name == "r")
+        return &Layer::r;
+    if (name == "g")
+        return &Layer::g;
+    if (name == "b")
+        return &Layer::b;
+    if (name == "alpha")
+        return &Layer::alpha;
+    if (name == "lineWidth")
+        return &Layer::lineWidth;
+    if (name == "fontSize")
+        return &Layer::fontSize;
+
+    return nullptr;
+}
+
+void Animator::Grow(DamageRect &damage, double x0, double y0, double x1, double y1) {
+    if (damage.empty) {
+        damage.x0 = x0;
+        damage.y0 = y0;
+        damage.x1 = x1;
+        damage.y1 = y1;
+        damage.empty = false;
+    } else {
+        damage.x0 = x0 < damage.x0 ? x0 : damage.x0;
+        damage.y0 = y0 < damage.y0 ? y0 : damage.y0;
+        damage.x1 = x1 > damage.x1 ? x1 : damage.x1;
+        damage.y1 = y1 > damage.y1 ? y1 : damage.y1;
+    }
+
+    return;
+}
+
+Animator::~Animator() {
+    for (size_t i = 0; i < this->layers.size(); i++) {
+        if (this->layers[i] != nullptr) {
+            if (this->layers[i]->image != nullptr)
+                cairo_surface_destroy(this->layers[i]->image);
+            delete this->layers[i];
+        }
+    }
+}
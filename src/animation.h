@@ -0,0 +1,95 @@
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include <cairo/cairo.h>
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum LayerType { LAYER_RECT, LAYER_CIRCLE, LAYER_LINE, LAYER_TEXT, LAYER_IMAGE };
+
+enum Easing { EASE_LINEAR, EASE_IN, EASE_OUT, EASE_IN_OUT, EASE_OUT_BACK, EASE_OUT_BOUNCE };
+
+// A retained primitive drawn over the back buffer on every blit. Layers are positioned at (x, y), rotated by
+// rotation degrees clockwise and scaled around that point. A line layer is length pixels long and points up when
+// its rotation is 0, which is what a gauge needle wants.
+struct Layer {
+    LayerType type;
+    bool visible;
+    bool filled;
+    bool centered;
+
+    double x, y;
+    double width, height;
+    double radius;
+    double length;
+    double rotation;
+    double scale;
+    double r, g, b, alpha;
+    double lineWidth;
+
+    std::string text;
+    std::string fontName;
+    double fontSize;
+    bool fontBold;
+
+    std::string path;
+    cairo_surface_t *image;
+};
+
+struct Animation {
+    size_t id;
+    size_t layer;
+    std::vector<double Layer::*> properties;
+    std::vector<double> from;
+    std::vector<double> to;
+    double start;
+    double duration;
+    Easing easing;
+};
+
+struct DamageRect {
+    double x0, y0, x1, y1;
+    bool empty;
+};
+
+class Animator {
+  public:
+    Animator();
+    ~Animator();
+
+    size_t CreateLayer(LayerType type);
+    Layer *GetLayer(size_t id);
+    void DestroyLayer(size_t id);
+
+    size_t Start(size_t layer, std::vector<double Layer::*> properties, std::vector<double> from,
+                 std::vector<double> to, double duration, Easing easing, double now);
+    void Stop(size_t id, bool jumpToEnd);
+    long LayerOf(size_t id);
+    bool Running();
+
+    // Advances all animations to now, grows damage by the area the changed layers covered before and after.
+    void Step(cairo_t *cr, double now, DamageRect &damage);
+    // Completion notices collected since the last call, as (animation id, completed) pairs.
+    std::vector<std::pair<size_t, bool>> TakeFinished();
+
+    void Bounds(cairo_t *cr, size_t layer, DamageRect &damage);
+    void Paint(cairo_t *cr);
+
+    static double Ease(Easing easing, double t);
+    static double Layer::*Property(const std::string &name);
+    static void Grow(DamageRect &damage, double x0, double y0, double x1, double y1);
+
+  private:
+    void Path(cairo_t *cr, Layer *layer);
+    void Apply(Animation &animation, double t);
+
+    std::vector<Layer *> layers;
+    std::vector<Animation> animations;
+    std::vector<std::pair<size_t, bool>> finished;
+    size_t nextAnimation;
+};
+
+#endif
@@ -0,0 +1,398 @@
+#include "assetpack.h"
+
+AssetPack::AssetPack(const std::string &path) {
+    struct stat st;
+
+    map = (char *)MAP_FAILED;
+    mapSize = 0;
+
+    fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        throw std::runtime_error("Error opening asset pack: " + path);
+
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(AssetPackHeader)) {
+        close(fd);
+        throw std::runtime_error("Error reading asset pack: " + path);
+    }
+
+    mapSize = st.st_size;
+    map = (char *)mmap(0, mapSize, PROT_READ, MAP_SHARED, fd, 0);
+
+    if (map == MAP_FAILED) {
+        close(fd);
+        throw std::runtime_error("Error during memory mapping: " + path);
+    }
+
+    const AssetPackHeader *header = (const AssetPackHeader *)map;
+
+    if (memcmp(header->magic, ASSETPACK_MAGIC, sizeof(header->magic)) != 0 || header->version != ASSETPACK_VERSION ||
+        sizeof(AssetPackHeader) + (size_t)header->count * sizeof(AssetPackEntry) > mapSize) {
+        munmap(map, mapSize);
+        close(fd);
+        throw std::runtime_error("Error reading asset pack, invalid header: " + path);
+    }
+
+    count = header->count;
+    entries = (const AssetPackEntry *)(map + sizeof(AssetPackHeader));
+
+    for (uint32_t i = 0; i < count; i++) {
+        const AssetPackEntry &entry = entries[i];
+        // surfaces are built over the mapping, so raw data must be aligned for 16 bit pixels and cover every row
+        bool valid = (uint64_t)entry.offset + entry.size <= mapSize &&
+                     (uint64_t)entry.alphaOffset + entry.alphaSize <= mapSize && entry.offset % 4 == 0 &&
+                     entry.alphaOffset % 4 == 0 && memchr(entry.name, 0, ASSETPACK_NAME_LENGTH) != nullptr;
+
+        if (valid && !(entry.flags & ASSET_RLE)) {
+            // cairo returns -1 for widths it cannot handle
+            int64_t colorStride = cairo_format_stride_for_width(CAIRO_FORMAT_RGB16_565, entry.width);
+            int64_t alphaStride = cairo_format_stride_for_width(CAIRO_FORMAT_A8, entry.width);
+
+            valid = colorStride >= (int64_t)entry.width * 2 &&
+                    (uint64_t)entry.size == (uint64_t)colorStride * entry.height;
+            if (entry.flags & ASSET_ALPHA)
+                valid = valid && alphaStride >= (int64_t)entry.width &&
+                        (uint64_t)entry.alphaSize == (uint64_t)alphaStride * entry.height;
+        }
+
+        if (!valid) {
+            munmap(map, mapSize);
+            close(fd);
+            throw std::runtime_error("Error reading asset pack, invalid entry: " + path);
+        }
+    }
+
+    surfaces.resize(count, nullptr);
+    alphas.resize(count, nullptr);
+
+    return;
+}
+
+int AssetPack::Find(const std::string &name) {
+    for (uint32_t i = 0; i < this->count; i++)
+        if (name == this->entries[i].name)
+            return i;
+
+    return -1;
+}
+
+std::vector<std::string> AssetPack::Names() {
+    std::vector<std::string> names;
+
+    for (uint32_t i = 0; i < this->count; i++)
+        names.push_back(this->entries[i].name);
+
+    return names;
+}
+
+cairo_surface_t *AssetPack::Surface(int index) {
+    const AssetPackEntry &entry = this->entries[index];
+
+    if (this->surfaces[index] != nullptr)
+        return this->surfaces[index];
+
+    if (entry.flags & ASSET_RLE)
+        this->surfaces[index] = this->Decode(entry, false);
+    else
+        // the mapping is read-only, cairo only ever reads from a source surface
+        this->surfaces[index] = cairo_image_surface_create_for_data(
+            (unsigned char *)(this->map + entry.offset), CAIRO_FORMAT_RGB16_565, entry.width, entry.height,
+            cairo_format_stride_for_width(CAIRO_FORMAT_RGB16_565, entry.width));
+
+    if (cairo_surface_status(this->surfaces[index]) != CAIRO_STATUS_SUCCESS)
+        throw std::runtime_error(std::string("Error creating asset surface: ") + entry.name);
+
+    return this->surfaces[index];
+}
+
+cairo_surface_t *AssetPack::Alpha(int index) {
+    const AssetPackEntry &entry = this->entries[index];
+
+    if (!(entry.flags & ASSET_ALPHA))
+        return nullptr;
+
+    if (this->alphas[index] != nullptr)
+        return this->alphas[index];
+
+    if (entry.flags & ASSET_RLE)
+        this->alphas[index] = this->Decode(entry, true);
+    else
+        this->alphas[index] = cairo_image_surface_create_for_data(
+            (unsigned char *)(this->map + entry.alphaOffset), CAIRO_FORMAT_A8, entry.width, entry.height,
+            cairo_format_stride_for_width(CAIRO_FORMAT_A8, entry.width));
+
+    if (cairo_surface_status(this->alphas[index]) != CAIRO_STATUS_SUCCESS)
+        throw std::runtime_error(std::string("Error creating asset surface: ") + entry.name);
+
+    return this->alphas[index];
+}
+
+size_t AssetPack::MappedSize() { return this->mapSize; }
+
+cairo_surface_t *AssetPack::Decode(const AssetPackEntry &entry, bool alpha) {
+    cairo_surface_t *surface =
+        cairo_image_surface_create(alpha ? CAIRO_FORMAT_A8 : CAIRO_FORMAT_RGB16_565, entry.width, entry.height);
+
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)
+        return surface;
+
+    cairo_surface_flush(surface);
+
+    unsigned char *data = cairo_image_surface_get_data(surface);
+    int stride = cairo_image_surface_get_stride(surface);
+    const unsigned char *run = (const unsigned char *)this->map + (alpha ? entry.alphaOffset : entry.offset);
+    const unsigned char *end = run + (alpha ? entry.alphaSize : entry.size);
+    size_t pixels = (size_t)entry.width * entry.height;
+    size_t i = 0;
+
+    while (i < pixels && run < end) {
+        uint16_t length, value;
+
+        if (alpha) {
+            if (run + 2 > end)
+                break;
+            length = run[0];
+            value = run[1];
+            run += 2;
+        } else {
+            if (run + 4 > end)
+                break;
+            memcpy(&length, run, 2);
+            memcpy(&value, run + 2, 2);
+            run += 4;
+        }
+
+        for (; length > 0 && i < pixels; length--, i++) {
+            unsigned char *row = data + (i / entry.width) * stride;
+
+            if (alpha)
+                row[i % entry.width] = value;
+            else
+                ((uint16_t *)row)[i % entry.width] = value;
+        }
+    }
+
+    cairo_surface_mark_dirty(surface);
+
+    return surface;
+}
+
+void AssetPack::Write(const std::string &path, const std::vector<std::pair<std::string, std::string>> &files,
+                      bool rle) {
+    std::vector<AssetPackEntry> index(files.size());
+    std::vector<std::vector<unsigned char>> colors(files.size());
+    std::vector<std::vector<unsigned char>> alphas(files.size());
+
+    for (size_t f = 0; f < files.size(); f++) {
+        AssetPackEntry &entry = index[f];
+
+        if (files[f].first.size() >= ASSETPACK_NAME_LENGTH)
+            throw std::runtime_error("Error packing asset, name too long: " + files[f].first);
+
+        cairo_surface_t *image = cairo_image_surface_create_from_png(files[f].second.c_str());
+        cairo_status_t status = cairo_surface_status(image);
+
+        if (status != CAIRO_STATUS_SUCCESS) {
+            cairo_surface_destroy(image);
+            throw std::runtime_error("Error reading image: " + files[f].second + " : " +
+                                     cairo_status_to_string(status));
+        }
+
+        // newer cairo loads 16 bit PNGs as float formats, the packer reads 32 bit pixels so those are converted
+        cairo_format_t loaded = cairo_image_surface_get_format(image);
+
+        if (loaded != CAIRO_FORMAT_ARGB32 && loaded != CAIRO_FORMAT_RGB24) {
+            cairo_surface_t *converted = cairo_image_surface_create(
+                CAIRO_FORMAT_ARGB32, cairo_image_surface_get_width(image), cairo_image_surface_get_height(image));
+            cairo_t *cr = cairo_create(converted);
+
+            cairo_set_source_surface(cr, image, 0, 0);
+            cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+            cairo_paint(cr);
+            status = cairo_status(cr);
+            cairo_destroy(cr);
+            cairo_surface_destroy(image);
+            image = converted;
+
+            if (status == CAIRO_STATUS_SUCCESS)
+                status = cairo_surface_status(image);
+
+            if (status != CAIRO_STATUS_SUCCESS) {
+                cairo_surface_destroy(image);
+                throw std::runtime_error("Error converting image: " + files[f].second + " : " +
+                                         cairo_status_to_string(status));
+            }
+        }
+
+        cairo_surface_flush(image);
+
+        int width = cairo_image_surface_get_width(image);
+        int height = cairo_image_surface_get_height(image);
+        int stride = cairo_image_surface_get_stride(image);
+        bool hasAlpha = false;
+        cairo_format_t format = cairo_image_surface_get_format(image);
+        unsigned char *data = cairo_image_surface_get_data(image);
+
+        int colorStride = cairo_format_stride_for_width(CAIRO_FORMAT_RGB16_565, width);
+        int alphaStride = cairo_format_stride_for_width(CAIRO_FORMAT_A8, width);
+        std::vector<unsigned char> color(colorStride * height, 0);
+        std::vector<unsigned char> alpha(alphaStride * height, 0);
+
+        for (int y = 0; y < height; y++) {
+            uint32_t *src = (uint32_t *)(data + y * stride);
+            uint16_t *dst = (uint16_t *)(color.data() + y * colorStride);
+
+            for (int x = 0; x < width; x++) {
+                uint32_t p = src[x];
+                uint32_t a = format == CAIRO_FORMAT_ARGB32 ? p >> 24 : 255;
+                uint32_t r = (p >> 16) & 0xff, g = (p >> 8) & 0xff, b = p & 0xff;
+
+                // cairo keeps premultiplied colour, the pack stores it straight and masks with alpha
+                if (a > 0 && a < 255) {
+                    r = r * 255 / a;
+                    g = g * 255 / a;
+                    b = b * 255 / a;
+                }
+
+                dst[x] = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+                alpha[y * alphaStride + x] = a;
+
+                if (a != 255)
+                    hasAlpha = true;
+            }
+        }
+
+        cairo_surface_destroy(image);
+
+        memset(&entry, 0, sizeof(entry));
+        strncpy(entry.name, files[f].first.c_str(), ASSETPACK_NAME_LENGTH - 1);
+        entry.width = width;
+        entry.height = height;
+        entry.flags = hasAlpha ? ASSET_ALPHA : 0;
+
+        if (!hasAlpha)
+            alpha.clear();
+
+        if (rle) {
+            std::vector<unsigned char> colorRuns, alphaRuns;
+
+            for (size_t i = 0, n = (size_t)width * height; i < n;) {
+                uint16_t value = ((uint16_t *)(color.data() + (i / width) * colorStride))[i % width];
+                uint16_t length = 0;
+
+                while (i < n && length < 65535 &&
+                       ((uint16_t *)(color.data() + (i / width) * colorStride))[i % width] == value) {
+                    length++;
+                    i++;
+                }
+
+                colorRuns.insert(colorRuns.end(), (unsigned char *)&length, (unsigned char *)&length + 2);
+                colorRuns.insert(colorRuns.end(), (unsigned char *)&value, (unsigned char *)&value + 2);
+            }
+
+            for (size_t i = 0, n = hasAlpha ? (size_t)width * height : 0; i < n;) {
+                unsigned char value = alpha[(i / width) * alphaStride + i % width];
+                unsigned char length = 0;
+
+                while (i < n && length < 255 && alpha[(i / width) * alphaStride + i % width] == value) {
+                    length++;
+                    i++;
+                }
+
+                alphaRuns.push_back(length);
+                alphaRuns.push_back(value);
+            }
+
+            // only worth it for flat art, photos stay raw so they can be used in place
+            if (colorRuns.size() + alphaRuns.size() < color.size() + alpha.size()) {
+                color.swap(colorRuns);
+                alpha.swap(alphaRuns);
+                entry.flags |= ASSET_RLE;
+            }
+        }
+
+        colors[f].swap(color);
+        alphas[f].swap(alpha);
+    }
+
+    // data blocks start 16 byte aligned so the mapped surfaces are SIMD friendly
+    size_t offset = sizeof(AssetPackHeader) + index.size() * sizeof(AssetPackEntry);
+
+    for (size_t f = 0; f < files.size(); f++) {
+        offset = (offset + 15) & ~(size_t)15;
+        index[f].offset = offset;
+        index[f].size = colors[f].size();
+        offset += colors[f].size();
+
+        offset = (offset + 15) & ~(size_t)15;
+        index[f].alphaOffset = alphas[f].empty() ? 0 : offset;
+        index[f].alphaSize = alphas[f].size();
+        offset += alphas[f].size();
+    }
+
+    if (offset > UINT32_MAX)
+        throw std::runtime_error("Error packing assets, pack too large");
+
+    // packs are used in place through mmap, truncating the target would pull the pages from under every reader,
+    // so the new pack is written next to it and renamed over it
+    std::string temp = path + ".XXXXXX";
+    int tempFd = mkstemp(&temp[0]);
+    if (tempFd == -1)
+        throw std::runtime_error("Error writing asset pack: " + path);
+
+    fchmod(tempFd, 0644);
+
+    FILE *out = fdopen(tempFd, "wb");
+    if (out == nullptr) {
+        close(tempFd);
+        unlink(temp.c_str());
+        throw std::runtime_error("Error writing asset pack: " + path);
+    }
+
+    AssetPackHeader header;
+    memcpy(header.magic, ASSETPACK_MAGIC, sizeof(header.magic));
+    header.version = ASSETPACK_VERSION;
+    header.count = index.size();
+
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+    if (!index.empty())
+        ok = ok && fwrite(index.data(), sizeof(AssetPackEntry), index.size(), out) == index.size();
+
+    static const unsigned char zeros[16] = {0};
+    size_t written = sizeof(AssetPackHeader) + index.size() * sizeof(AssetPackEntry);
+
+    for (size_t f = 0; f < files.size() && ok; f++) {
+        ok = fwrite(zeros, 1, index[f].offset - written, out) == index[f].offset - written;
+        ok = ok && fwrite(colors[f].data(), 1, colors[f].size(), out) == colors[f].size();
+        written = index[f].offset + colors[f].size();
+
+        if (!alphas[f].empty()) {
+            ok = ok && fwrite(zeros, 1, index[f].alphaOffset - written, out) == index[f].alphaOffset - written;
+            ok = ok && fwrite(alphas[f].data(), 1, alphas[f].size(), out) == alphas[f].size();
+            written = index[f].alphaOffset + alphas[f].size();
+        }
+    }
+
+    ok = ok && fflush(out) == 0 && fsync(fileno(out)) == 0;
+
+    if (fclose(out) != 0 || !ok || rename(temp.c_str(), path.c_str()) != 0) {
+        unlink(temp.c_str());
+        throw std::runtime_error("Error writing asset pack: " + path);
+    }
+
+    return;
+}
+
+AssetPack::~AssetPack() {
+    for (size_t i = 0; i < surfaces.size(); i++) {
+        if (surfaces[i] != nullptr)
+            cairo_surface_destroy(surfaces[i]);
+        if (alphas[i] != nullptr)
+            cairo_surface_destroy(alphas[i]);
+    }
+
+    if (map != MAP_FAILED)
+        munmap(map, mapSize);
+
+    if (fd != -1)
+        close(fd);
+}
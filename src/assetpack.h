@@ -0,0 +1,79 @@
+#ifndef ASSETPACK_H
+#define ASSETPACK_H
+
+#include <cairo/cairo.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Asset pack layout, all little endian:
+//   AssetPackHeader, then count AssetPackEntry records, then the pixel data.
+// Raw RGB565 rows use cairo's stride for the width so the data can be wrapped in a surface without copying,
+// the optional alpha plane is an A8 surface the same way. RLE data is a list of (uint16 count, uint16 pixel)
+// runs for colour and (uint8 count, uint8 alpha) runs for alpha, running across rows.
+
+#define ASSETPACK_MAGIC "PTFTPAK1"
+#define ASSETPACK_VERSION 1
+#define ASSETPACK_NAME_LENGTH 96
+
+#define ASSET_ALPHA 1
+#define ASSET_RLE 2
+
+struct AssetPackHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+};
+
+struct AssetPackEntry {
+    char name[ASSETPACK_NAME_LENGTH];
+    uint32_t width;
+    uint32_t height;
+    uint32_t flags;
+    uint32_t reserved;
+    uint32_t offset;
+    uint32_t size;
+    uint32_t alphaOffset;
+    uint32_t alphaSize;
+};
+
+class AssetPack {
+  public:
+    AssetPack(const std::string &path);
+    ~AssetPack();
+
+    int Find(const std::string &name);
+    std::vector<std::string> Names();
+    // Surfaces are created on first use, raw entries point straight into the mapping.
+    cairo_surface_t *Surface(int index);
+    cairo_surface_t *Alpha(int index);
+    size_t MappedSize();
+
+    static void Write(const std::string &path, const std::vector<std::pair<std::string, std::string>> &files,
+                      bool rle);
+
+  private:
+    cairo_surface_t *Decode(const AssetPackEntry &entry, bool alpha);
+
+    int fd;
+    char *map;
+    size_t mapSize;
+
+    const AssetPackEntry *entries;
+    uint32_t count;
+
+    std::vector<cairo_surface_t *> surfaces;
+    std::vector<cairo_surface_t *> alphas;
+};
+
+#endif
@@ -0,0 +1,48 @@
+#include "assetpackWrapper.h"
+#include "options.h"
+
+Napi::Object AssetPackWrapper::Init(Napi::Env env, Napi::Object exports) {
+    Napi::HandleScope scope(env);
+
+    exports.Set("packAssets", Napi::Function::New(env, AssetPackWrapper::Pack, "packAssets"));
+
+    return exports;
+}
+
+Napi::Value AssetPackWrapper::Pack(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+    std::vector<std::pair<std::string, std::string>> files;
+    bool rle = false;
+
+    // output path, then { name: pngPath } and optional { rle: true }
+    if (!info[0].IsString() || !info[1].IsObject()) {
+        Napi::TypeError::New(env, "expected output path and images").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    if (info[2].IsObject())
+        rle = OptionBoolean(info[2].As<Napi::Object>(), "rle", false);
+
+    Napi::Object images = info[1].As<Napi::Object>();
+    Napi::Array names = images.GetPropertyNames();
+
+    for (uint32_t i = 0; i < names.Length(); i++) {
+        std::string name = names.Get(i).As<Napi::String>().Utf8Value();
+
+        if (!images.Get(name).IsString()) {
+            Napi::TypeError::New(env, "invalid image path for " + name).ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+
+        files.push_back(std::make_pair(name, images.Get(name).As<Napi::String>().Utf8Value()));
+    }
+
+    try {
+        AssetPack::Write(info[0].As<Napi::String>().Utf8Value(), files, rle);
+    } catch (const std::exception &e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+
+    return env.Undefined();
+}
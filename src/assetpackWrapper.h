@@ -0,0 +1,15 @@
+#ifndef ASSETPACKWRAPPER_H
+#define ASSETPACKWRAPPER_H
+
+#include "assetpack.h"
+#include <napi.h>
+
+class AssetPackWrapper {
+  public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+
+  private:
+    static Napi::Value Pack(const Napi::CallbackInfo &info);
+};
+
+#endif
@@ -1,8 +1,45 @@
 #include "framebuffer.h"
 
-FrameBuffer::FrameBuffer(std::string wd, const char *path, bool drawToBuff) {
+#include <math.h>
+#include <time.h>
+
+#include <algorithm>
+
+#define QUALITY_COARSE 1
+#define QUALITY_ALIASED 2
+#define QUALITY_SOLID 3
+
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+static double Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+FrameBuffer::FrameBuffer(std::string wd, const char *path, bool drawToBuff, bool renderThread, double scale) {
     cwd = wd;
     drawToBuffer = drawToBuff;
+    threaded = renderThread;
+    bufferScale = scale > 0 && scale < 1 ? scale : 1;
+    bbp = nullptr;
+    bufferSurface = nullptr;
+    presentedSurface = nullptr;
+    bufferSize = 0;
+
+    r = g = b = 1;
+    usedPattern = 0;
+    usePattern = false;
+    patternSlots = 0;
+    fontName = "Sans";
+    fontSize = 12;
+    fontBold = false;
+    frameBudget = 0;
+    frameCost = 0;
+    frameWork = 0;
+    overBudget = underBudget = 0;
+    quality = 0;
 
     fbfd = open(path, O_RDWR);
     if (fbfd == -1) {
@@ -30,67 +67,375 @@ FrameBuffer::FrameBuffer(std::string wd, const char *path, bool drawToBuff) {
 
     screenSize = finfo.smem_len;
     fbp = (char *)mmap(0, screenSize, PROT_READ | PROT_WRITE, MAP_SHARED, fbfd, 0);
-    bbp = (char *)malloc(screenSize);
+    ownsBuffer = true;
 
     if ((int)fbp == -1) {
         throw std::runtime_error("Error during memory mapping");
         return;
     }
 
-    bufferSurface =
-        cairo_image_surface_create_for_data((unsigned char *)bbp, CAIRO_FORMAT_RGB16_565, vinfo.xres, vinfo.yres,
-                                            cairo_format_stride_for_width(CAIRO_FORMAT_RGB16_565, vinfo.xres));
+    // the back buffer covers the visible area only (smem_len can be several screens), at the internal resolution
+    bufferWidth = ceil(vinfo.xres * bufferScale);
+    bufferHeight = ceil(vinfo.yres * bufferScale);
 
-    if (cairo_surface_status(bufferSurface) != CAIRO_STATUS_SUCCESS) {
-        throw std::runtime_error("Error creating buffer surface");
-        return;
+    if (drawToBuffer) {
+        bufferSize = BufferStride() * bufferHeight;
+        bbp = AllocateBuffer(bufferSize);
+
+        bufferSurface = cairo_image_surface_create_for_data((unsigned char *)bbp, CAIRO_FORMAT_RGB16_565, bufferWidth,
+                                                            bufferHeight, BufferStride());
+
+        if (cairo_surface_status(bufferSurface) != CAIRO_STATUS_SUCCESS) {
+            throw std::runtime_error("Error creating buffer surface");
+            return;
+        }
     }
 
     screenSurface =
         cairo_image_surface_create_for_data((unsigned char *)fbp, CAIRO_FORMAT_RGB16_565, vinfo.xres, vinfo.yres,
                                             cairo_format_stride_for_width(CAIRO_FORMAT_RGB16_565, vinfo.xres));
 
-    if (cairo_surface_status(bufferSurface) != CAIRO_STATUS_SUCCESS)
+    if (cairo_surface_status(screenSurface) != CAIRO_STATUS_SUCCESS)
         throw std::runtime_error("Error creating screen surface");
 
+    stopping = false;
+    busy = false;
+
+    if (threaded)
+        worker = std::thread(&FrameBuffer::RenderLoop, this);
+
+    return;
+}
+
+void FrameBuffer::Run(std::function<void()> command) {
+    // threaded panels record draw calls and rasterize them on their own thread at blit time
+    if (this->threaded)
+        this->recording.push_back(command);
+    else {
+        // a render server may present from its own thread
+        std::lock_guard<std::mutex> lock(this->renderLock);
+
+        if (this->frameBudget > 0) {
+            double start = Now();
+            command();
+            this->frameWork += Now() - start;
+        } else
+            command();
+    }
+
     return;
 }
 
 void FrameBuffer::Clear() {
-    cairo_t *cr = getDrawingContext(this);
+    this->Run([=]() {
+        cairo_t *cr = getDrawingContext(this);
 
-    cairo_set_source_rgb(cr, 0, 0, 0);
-    cairo_paint(cr);
-    cairo_destroy(cr);
+        cairo_set_source_rgb(cr, 0, 0, 0);
+        cairo_paint(cr);
+        cairo_destroy(cr);
+    });
 
     return;
 }
 
 void FrameBuffer::Blit() {
+    this->Submit(std::shared_ptr<SyncGroup>(), true);
+
+    return;
+}
+
+void FrameBuffer::BlitSync(const std::vector<FrameBuffer *> &list) {
+    std::vector<FrameBuffer *> frameBuffers;
+    int count = 0;
+
+    // a panel listed twice would wait for its own second arrival, each one is blitted once
+    for (size_t i = 0; i < list.size(); i++)
+        if (std::find(frameBuffers.begin(), frameBuffers.end(), list[i]) == frameBuffers.end())
+            frameBuffers.push_back(list[i]);
+
+    for (size_t i = 0; i < frameBuffers.size(); i++)
+        if (frameBuffers[i]->threaded)
+            count++;
+
+    // every threaded panel rasterizes its frame, waits for the others, then they all present
+    std::shared_ptr<SyncGroup> group = std::make_shared<SyncGroup>(count);
+
+    // a pending render error of one panel is thrown after all of them joined the group, the others would wait
+    // for it forever otherwise
+    std::string error;
+
+    for (size_t i = 0; i < frameBuffers.size(); i++) {
+        try {
+            frameBuffers[i]->Submit(group, true);
+        } catch (const std::exception &e) {
+            if (error.empty())
+                error = e.what();
+        }
+    }
+
+    if (!error.empty())
+        throw std::runtime_error(error);
+
+    return;
+}
+
+void FrameBuffer::Submit(std::shared_ptr<SyncGroup> group, bool present) {
+    if (!this->threaded) {
+        std::lock_guard<std::mutex> lock(this->renderLock);
+        double start = Now();
+
+        if (present) {
+            this->Present();
+            this->Govern(this->frameWork + Now() - start);
+        }
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(this->queueLock);
+
+    // keep at most two frames in flight so JS cannot run away from the panel
+    this->queueCond.wait(lock, [this]() { return this->frames.size() < 2; });
+
+    RenderFrame frame;
+    frame.commands.swap(this->recording);
+    frame.group = group;
+    frame.present = present;
+
+    this->frames.push_back(std::move(frame));
+    this->queueCond.notify_all();
+
+    this->RethrowError();
+
+    return;
+}
+
+void FrameBuffer::Flush() {
+    if (!this->threaded)
+        return;
+
+    // draw whatever was recorded since the last blit, without presenting it
+    if (!this->recording.empty())
+        this->Submit(std::shared_ptr<SyncGroup>(), false);
+
+    std::unique_lock<std::mutex> lock(this->queueLock);
+    this->queueCond.wait(lock, [this]() { return this->frames.empty() && !this->busy; });
+
+    this->RethrowError();
+
+    return;
+}
+
+void FrameBuffer::RethrowError() {
+    if (this->renderError.empty())
+        return;
+
+    std::string error = this->renderError;
+    this->renderError.clear();
+
+    throw std::runtime_error(error);
+}
+
+void FrameBuffer::RenderLoop() {
+    while (true) {
+        RenderFrame frame;
+
+        {
+            std::unique_lock<std::mutex> lock(this->queueLock);
+            this->queueCond.wait(lock, [this]() { return this->stopping || !this->frames.empty(); });
+
+            if (this->frames.empty())
+                break;
+
+            frame = std::move(this->frames.front());
+            this->frames.pop_front();
+            this->busy = true;
+            this->queueCond.notify_all();
+        }
+
+        std::string error;
+        double start = Now();
+
+        {
+            std::lock_guard<std::mutex> lock(this->renderLock);
+
+            for (size_t i = 0; i < frame.commands.size(); i++) {
+                try {
+                    frame.commands[i]();
+                } catch (const std::exception &e) {
+                    // reported to JS on the next blit
+                    if (error.empty())
+                        error = e.what();
+                }
+            }
+        }
+
+        // time spent waiting for the other panels is not this panel's cost
+        this->frameWork += Now() - start;
+
+        if (frame.group)
+            frame.group->ArriveAndWait();
+
+        if (frame.present) {
+            std::lock_guard<std::mutex> lock(this->renderLock);
+            start = Now();
+            this->Present();
+            this->Govern(this->frameWork + Now() - start);
+        }
+
+        std::lock_guard<std::mutex> lock(this->queueLock);
+        if (!error.empty() && this->renderError.empty())
+            this->renderError = error;
+        this->busy = false;
+        this->queueCond.notify_all();
+    }
+
+    return;
+}
+
+void FrameBuffer::Present() {
     if (this->drawToBuffer) {
-        cairo_t *cr = cairo_create(this->screenSurface);
-        cairo_set_source_surface(cr, this->bufferSurface, 0, 0);
+        this->Snapshot();
+        this->Composite();
+    }
+
+    return;
+}
+
+void FrameBuffer::Composite() {
+    cairo_t *cr = cairo_create(this->screenSurface);
+    this->PaintBuffer(cr);
+    this->animator.Paint(cr);
+    for (size_t i = 0; i < this->overlays.size(); i++)
+        this->overlays[i]->Paint(cr);
+    cairo_destroy(cr);
+
+    return;
+}
+
+void FrameBuffer::Snapshot() {
+    // a shared back buffer is written by workers behind cairo's back
+    if (!this->ownsBuffer)
+        cairo_surface_mark_dirty(this->bufferSurface);
+
+    // without layers or overlays nothing is repainted between blits, the back buffer is painted as it is
+    if (this->presentedSurface == nullptr)
+        return;
+
+    cairo_surface_flush(this->bufferSurface);
+    cairo_surface_flush(this->presentedSurface);
+    memcpy(cairo_image_surface_get_data(this->presentedSurface), this->bbp, this->bufferSize);
+    cairo_surface_mark_dirty(this->presentedSurface);
+
+    return;
+}
+
+void FrameBuffer::AllocateSnapshot() {
+    if (!this->drawToBuffer || this->presentedSurface != nullptr)
+        return;
+
+    cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_RGB16_565, this->bufferWidth,
+                                                          this->bufferHeight);
+
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(surface);
+        throw std::runtime_error("Error creating buffer surface");
+    }
+
+    // the back buffer is the closest thing to what was last blitted until the next blit replaces it
+    this->presentedSurface = surface;
+    this->Snapshot();
+
+    return;
+}
+
+void FrameBuffer::PaintBuffer(cairo_t *cr) {
+    cairo_surface_t *source = this->presentedSurface != nullptr ? this->presentedSurface : this->bufferSurface;
+
+    if (this->bufferScale == 1) {
+        cairo_set_source_surface(cr, source, 0, 0);
         cairo_paint(cr);
-        cairo_destroy(cr);
+        return;
     }
 
+    // a reduced resolution back buffer is stretched to the screen, padding keeps bilinear filtering from blending
+    // the screen edges with transparent black
+    cairo_save(cr);
+    cairo_scale(cr, 1 / this->bufferScale, 1 / this->bufferScale);
+    cairo_set_source_surface(cr, source, 0, 0);
+    cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_BILINEAR);
+    cairo_pattern_set_extend(cairo_get_source(cr), CAIRO_EXTEND_PAD);
+    cairo_paint(cr);
+    cairo_restore(cr);
+
+    return;
+}
+
+void FrameBuffer::PresentRegion(const DamageRect &damage) {
+    if (damage.empty)
+        return;
+
+    double x0 = floor(damage.x0), y0 = floor(damage.y0);
+    double x1 = ceil(damage.x1), y1 = ceil(damage.y1);
+
+    x0 = x0 < 0 ? 0 : x0;
+    y0 = y0 < 0 ? 0 : y0;
+    x1 = x1 > this->vinfo.xres ? this->vinfo.xres : x1;
+    y1 = y1 > this->vinfo.yres ? this->vinfo.yres : y1;
+
+    if (x1 <= x0 || y1 <= y0)
+        return;
+
+    // restore what the last blit showed under the damaged area and draw the layers over it, drawing since then
+    // stays in the back buffer until the next blit
+    cairo_t *cr = cairo_create(this->screenSurface);
+    cairo_rectangle(cr, x0, y0, x1 - x0, y1 - y0);
+    cairo_clip(cr);
+    this->PaintBuffer(cr);
+    this->animator.Paint(cr);
+    for (size_t i = 0; i < this->overlays.size(); i++)
+        this->overlays[i]->Paint(cr);
+    cairo_destroy(cr);
+
     return;
 }
 
 void FrameBuffer::Color(double r, double g, double b) {
-    if (g == -1) {
-        this->usedPattern = (r);
-        this->usePattern = true;
-    } else {
-        this->r = r;
-        this->g = g;
-        this->b = b;
-        this->usePattern = false;
-    }
+    this->Run([=]() {
+        if (g == -1) {
+            this->usedPattern = (r);
+            this->usePattern = true;
+        } else {
+            this->r = r;
+            this->g = g;
+            this->b = b;
+            this->usePattern = false;
+        }
+    });
 
     return;
 }
 
+size_t FrameBuffer::PatternStore(size_t pos, cairo_pattern_t *created) {
+    // the index is handed out right away, the pattern lands in the table in draw order
+    if (pos == (size_t)-1)
+        pos = this->patternSlots;
+
+    if (pos >= this->patternSlots)
+        this->patternSlots = pos + 1;
+
+    this->Run([=]() {
+        while (this->pattern.size() <= pos)
+            this->pattern.push_back(nullptr);
+
+        if (this->pattern[pos] != nullptr)
+            cairo_pattern_destroy(this->pattern[pos]);
+
+        this->pattern[pos] = created;
+    });
+
+    return pos;
+}
+
 size_t FrameBuffer::PatternCreateLinear(double arg0, double arg1, double arg2, double arg3, double arg4) {
     double x0, y0, x1, y1;
     size_t pos;
@@ -100,22 +445,14 @@ size_t FrameBuffer::PatternCreateLinear(double arg0, double arg1, double arg2, d
         y0 = arg1;
         x1 = arg2;
         y1 = arg3;
-        this->pattern.push_back(cairo_pattern_create_linear(x0, y0, x1, y1));
-        pos = this->pattern.size() - 1;
+        pos = this->PatternStore(-1, cairo_pattern_create_linear(x0, y0, x1, y1));
     } else {
         pos = arg0;
         x0 = arg1;
         y0 = arg2;
         x1 = arg3;
         y1 = arg4;
-
-        while (this->pattern.size() <= pos)
-            this->pattern.push_back(nullptr);
-
-        if (this->pattern[pos] != nullptr)
-            cairo_pattern_destroy(this->pattern[pos]);
-
-        this->pattern[pos] = cairo_pattern_create_linear(x0, y0, x1, y1);
+        this->PatternStore(pos, cairo_pattern_create_linear(x0, y0, x1, y1));
     }
 
     return pos;
@@ -130,45 +467,157 @@ size_t FrameBuffer::PatternCreateRGB(double arg0, double arg1, double arg2, doub
         g = arg1;
         b = arg2;
         a = arg3;
-        this->pattern.push_back(cairo_pattern_create_rgba(r, g, b, a));
-        pos = this->pattern.size() - 1;
+        pos = this->PatternStore(-1, cairo_pattern_create_rgba(r, g, b, a));
     } else {
         pos = arg0;
         r = arg1;
         g = arg2;
         b = arg3;
         a = arg4;
+        this->PatternStore(pos, cairo_pattern_create_rgba(r, g, b, a));
+    }
 
-        while (this->pattern.size() <= pos)
-            this->pattern.push_back(nullptr);
+    return pos;
+}
 
-        if (this->pattern[pos] != nullptr)
-            cairo_pattern_destroy(this->pattern[pos]);
+void FrameBuffer::PatternAddColorStop(size_t patternIndex, double offset, double r, double g, double b, double alpha) {
+    this->Run([=]() {
+        if (alpha != -1)
+            cairo_pattern_add_color_stop_rgba(this->pattern[patternIndex], offset, r, g, b, alpha);
+        else
+            cairo_pattern_add_color_stop_rgb(this->pattern[patternIndex], offset, r, g, b);
+    });
+
+    return;
+}
 
-        this->pattern[pos] = cairo_pattern_create_rgba(r, g, b, a);
+void FrameBuffer::PatternDestroy(size_t patternIndex) {
+    this->Run([=]() {
+        cairo_pattern_destroy(this->pattern[patternIndex]);
+
+        this->pattern[patternIndex] = nullptr;
+    });
+
+    return;
+}
+
+size_t FrameBuffer::LayerCreate(LayerType type) {
+    if (!this->drawToBuffer)
+        throw std::runtime_error("Error creating layer, layers need double buffering");
+
+    std::lock_guard<std::mutex> lock(this->renderLock);
+    this->AllocateSnapshot();
+
+    return this->animator.CreateLayer(type);
+}
+
+bool FrameBuffer::GetLayer(size_t id, Layer &layer) {
+    std::lock_guard<std::mutex> lock(this->renderLock);
+    Layer *current = this->animator.GetLayer(id);
+
+    if (current == nullptr)
+        return false;
+
+    layer = *current;
+
+    return true;
+}
+
+void FrameBuffer::LayerUpdate(size_t id, const Layer &next) {
+    std::lock_guard<std::mutex> lock(this->renderLock);
+    Layer *layer = this->animator.GetLayer(id);
+    DamageRect damage = {0, 0, 0, 0, true};
+
+    if (layer == nullptr)
+        throw std::runtime_error("Error using layer, layer not exists");
+
+    cairo_t *cr = cairo_create(this->screenSurface);
+    this->animator.Bounds(cr, id, damage);
+
+    cairo_surface_t *image = layer->image;
+    std::string oldPath = layer->path;
+
+    *layer = next;
+    layer->image = image;
+
+    if (layer->path != oldPath) {
+        if (layer->image != nullptr)
+            cairo_surface_destroy(layer->image);
+        layer->image = nullptr;
+
+        if (!layer->path.empty()) {
+            try {
+                layer->image = Renderer::Image(cwd + "/" + layer->path);
+            } catch (const std::exception &e) {
+                cairo_destroy(cr);
+                throw;
+            }
+        }
     }
 
-    return pos;
+    this->animator.Bounds(cr, id, damage);
+    cairo_destroy(cr);
+
+    this->PresentRegion(damage);
+
+    return;
 }
 
-void FrameBuffer::PatternAddColorStop(size_t patternIndex, double offset, double r, double g, double b, double alpha) {
+void FrameBuffer::LayerDestroy(size_t id) {
+    std::lock_guard<std::mutex> lock(this->renderLock);
+    DamageRect damage = {0, 0, 0, 0, true};
 
-    if (alpha != -1)
-        cairo_pattern_add_color_stop_rgba(this->pattern[patternIndex], offset, r, g, b, alpha);
-    else
-        cairo_pattern_add_color_stop_rgb(this->pattern[patternIndex], offset, r, g, b);
+    cairo_t *cr = cairo_create(this->screenSurface);
+    this->animator.Bounds(cr, id, damage);
+    cairo_destroy(cr);
+
+    this->animator.DestroyLayer(id);
+    this->PresentRegion(damage);
 
     return;
 }
 
-void FrameBuffer::PatternDestroy(size_t patternIndex) {
-    cairo_pattern_destroy(this->pattern[patternIndex]);
+size_t FrameBuffer::Animate(size_t layer, std::vector<double Layer::*> properties, std::vector<double> from,
+                            std::vector<double> to, double duration, Easing easing, double now) {
+    std::lock_guard<std::mutex> lock(this->renderLock);
+
+    return this->animator.Start(layer, properties, from, to, duration, easing, now);
+}
+
+void FrameBuffer::AnimationStop(size_t id, bool jumpToEnd) {
+    std::lock_guard<std::mutex> lock(this->renderLock);
+    DamageRect damage = {0, 0, 0, 0, true};
+    long layer = this->animator.LayerOf(id);
+
+    cairo_t *cr = cairo_create(this->screenSurface);
+    if (layer != -1)
+        this->animator.Bounds(cr, layer, damage);
+
+    this->animator.Stop(id, jumpToEnd);
+
+    if (layer != -1)
+        this->animator.Bounds(cr, layer, damage);
+    cairo_destroy(cr);
 
-    this->pattern[patternIndex] = nullptr;
+    this->PresentRegion(damage);
 
     return;
 }
 
+bool FrameBuffer::AnimationStep(double now, std::vector<std::pair<size_t, bool>> &finished) {
+    std::lock_guard<std::mutex> lock(this->renderLock);
+    DamageRect damage = {0, 0, 0, 0, true};
+
+    cairo_t *cr = cairo_create(this->screenSurface);
+    this->animator.Step(cr, now, damage);
+    cairo_destroy(cr);
+
+    this->PresentRegion(damage);
+    finished = this->animator.TakeFinished();
+
+    return this->animator.Running();
+}
+
 #define cairoSetSourceMacro(cr, obj)                                                                                   \
     if (obj->usePattern) {                                                                                             \
         if (obj->pattern.size() <= obj->usedPattern) {                                                                 \
@@ -183,141 +632,379 @@ void FrameBuffer::PatternDestroy(size_t patternIndex) {
             throw std::runtime_error("Error using pattern, pattern status invalid");                                   \
             return;                                                                                                    \
         }                                                                                                              \
-        cairo_set_source(cr, obj->pattern[obj->usedPattern]);                                                          \
+        cairo_pattern_t *source = obj->pattern[obj->usedPattern];                                                      \
+        cairo_pattern_type_t sourceType = cairo_pattern_get_type(source);                                              \
+        double stop[5];                                                                                                \
+        /* the solid quality level paints gradients with their first stop, anything else keeps its pattern */          \
+        if (obj->quality >= QUALITY_SOLID &&                                                                           \
+            (sourceType == CAIRO_PATTERN_TYPE_LINEAR || sourceType == CAIRO_PATTERN_TYPE_RADIAL) &&                    \
+            cairo_pattern_get_color_stop_rgba(source, 0, &stop[0], &stop[1], &stop[2], &stop[3], &stop[4]) ==          \
+                CAIRO_STATUS_SUCCESS)                                                                                  \
+            cairo_set_source_rgba(cr, stop[1], stop[2], stop[3], stop[4]);                                             \
+        else                                                                                                           \
+            cairo_set_source(cr, source);                                                                              \
     } else {                                                                                                           \
         cairo_set_source_rgb(cr, obj->r, obj->g, obj->b);                                                              \
     }
 
 void FrameBuffer::Fill() {
-    cairo_t *cr = getDrawingContext(this);
+    this->Run([=]() {
+        cairo_t *cr = getDrawingContext(this);
 
-    cairoSetSourceMacro(cr, this);
-    cairo_paint(cr);
-    cairo_destroy(cr);
+        cairoSetSourceMacro(cr, this);
+        cairo_paint(cr);
+        cairo_destroy(cr);
+    });
 
     return;
 }
 
 void FrameBuffer::Line(double x0, double y0, double x1, double y1, double w) {
-    cairo_t *cr = getDrawingContext(this);
+    this->Run([=]() {
+        cairo_t *cr = getDrawingContext(this);
 
-    cairoSetSourceMacro(cr, this);
-    cairo_move_to(cr, x0, y0);
-    cairo_line_to(cr, x1, y1);
-    cairo_set_line_width(cr, w);
-    cairo_stroke(cr);
-    cairo_destroy(cr);
+        cairoSetSourceMacro(cr, this);
+        cairo_move_to(cr, x0, y0);
+        cairo_line_to(cr, x1, y1);
+        cairo_set_line_width(cr, w);
+        cairo_stroke(cr);
+        cairo_destroy(cr);
+    });
 
     return;
 }
 
 void FrameBuffer::Rect(double x, double y, double w, double h, bool filled, double lineWidth) {
-    cairo_t *cr = getDrawingContext(this);
+    this->Run([=]() {
+        cairo_t *cr = getDrawingContext(this);
 
-    cairoSetSourceMacro(cr, this);
-    cairo_rectangle(cr, x, y, w, h);
+        cairoSetSourceMacro(cr, this);
+        cairo_rectangle(cr, x, y, w, h);
 
-    if (filled == false) {
-        cairo_set_line_width(cr, lineWidth);
-        cairo_stroke(cr);
-    } else
-        cairo_fill(cr);
+        if (filled == false) {
+            cairo_set_line_width(cr, lineWidth);
+            cairo_stroke(cr);
+        } else
+            cairo_fill(cr);
 
-    cairo_destroy(cr);
+        cairo_destroy(cr);
+    });
 
     return;
 }
 
 void FrameBuffer::Circle(double x, double y, double radius, bool filled, double lineWidth) {
-    cairo_t *cr = getDrawingContext(this);
+    this->Run([=]() {
+        cairo_t *cr = getDrawingContext(this);
 
-    cairoSetSourceMacro(cr, this);
-    cairo_arc(cr, x, y, radius, 0, 2 * 3.141592654);
+        cairoSetSourceMacro(cr, this);
+        cairo_arc(cr, x, y, radius, 0, 2 * 3.141592654);
 
-    if (filled == false) {
-        cairo_set_line_width(cr, lineWidth);
-        cairo_stroke(cr);
-    } else
-        cairo_fill(cr);
+        if (filled == false) {
+            cairo_set_line_width(cr, lineWidth);
+            cairo_stroke(cr);
+        } else
+            cairo_fill(cr);
 
-    cairo_destroy(cr);
+        cairo_destroy(cr);
+    });
 
     return;
 }
 
 void FrameBuffer::Font(std::string fontName, double fontSize, bool fontBold) {
-    this->fontName = fontName.c_str();
-    this->fontSize = fontSize;
-    this->fontBold = fontBold;
+    this->Run([=]() {
+        this->fontName = fontName;
+        this->fontSize = fontSize;
+        this->fontBold = fontBold;
+    });
 
     return;
 }
 
 void FrameBuffer::Text(double x, double y, std::string text, bool textCentered, double textRotation, bool textRight) {
-    cairo_t *cr = getDrawingContext(this);
-    cairoSetSourceMacro(cr, this);
-
-    if (this->fontBold)
-        cairo_select_font_face(cr, this->fontName, CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
-    else
-        cairo_select_font_face(cr, this->fontName, CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
-
-    cairo_set_font_size(cr, this->fontSize);
-    cairo_translate(cr, x, y);
-
-    if (textRotation != 0)
-        cairo_rotate(cr, textRotation / (180.0 / 3.141592654));
-
-    if (textCentered) {
-        cairo_text_extents_t extents;
-        cairo_text_extents(cr, text.c_str(), &extents);
-        cairo_move_to(cr, -extents.width / 2, extents.height / 2);
-    } else if (textRight) {
-        cairo_text_extents_t extents;
-        cairo_text_extents(cr, text.c_str(), &extents);
-        cairo_move_to(cr, -extents.width, 0);
-    }
-
-    cairo_show_text(cr, text.c_str());
-    cairo_destroy(cr);
+    this->Run([=]() {
+        cairo_t *cr = getDrawingContext(this);
+        cairoSetSourceMacro(cr, this);
+
+        // faces come from the shared cache so every panel reuses the same glyph caches
+        cairo_font_face_t *face = Renderer::FontFace(this->fontName, this->fontBold);
+        cairo_set_font_face(cr, face);
+        cairo_font_face_destroy(face);
+
+        cairo_set_font_size(cr, this->fontSize);
+        cairo_translate(cr, x, y);
+
+        if (textRotation != 0)
+            cairo_rotate(cr, textRotation / (180.0 / 3.141592654));
+
+        if (textCentered) {
+            cairo_text_extents_t extents;
+            cairo_text_extents(cr, text.c_str(), &extents);
+            cairo_move_to(cr, -extents.width / 2, extents.height / 2);
+        } else if (textRight) {
+            cairo_text_extents_t extents;
+            cairo_text_extents(cr, text.c_str(), &extents);
+            cairo_move_to(cr, -extents.width, 0);
+        }
+
+        cairo_show_text(cr, text.c_str());
+        cairo_destroy(cr);
+    });
 
     return;
 }
 
 void FrameBuffer::Image(double x, double y, std::string path) {
+    this->Run([=]() { this->DrawImage(x, y, path); });
+
+    return;
+}
+
+void FrameBuffer::DrawImage(double x, double y, std::string path) {
+    // packed assets are drawn in place from the mapping, no decode
+    for (size_t i = this->assetPacks.size(); i-- > 0;) {
+        int index = this->assetPacks[i]->Find(path);
+
+        if (index == -1)
+            continue;
+
+        cairo_surface_t *image = this->assetPacks[i]->Surface(index);
+        cairo_surface_t *alpha = this->assetPacks[i]->Alpha(index);
+        cairo_t *cr = getDrawingContext(this);
+
+        cairo_set_source_surface(cr, image, x, y);
+
+        if (alpha != nullptr)
+            cairo_mask_surface(cr, alpha, x, y);
+        else
+            cairo_paint(cr);
+
+        cairo_destroy(cr);
+
+        return;
+    }
+
     path = cwd + "/" + path;
+    cairo_surface_t *image = Renderer::Image(path);
     cairo_t *cr = getDrawingContext(this);
-    cairo_surface_t *image = cairo_image_surface_create_from_png(path.c_str());
 
     cairo_set_source_surface(cr, image, x, y);
     cairo_paint(cr);
 
-    cairo_status_t status = cairo_status(cr);
-
-    if (status != CAIRO_STATUS_SUCCESS)
-        throw std::runtime_error("Error reading image: " + path + " : " + cairo_status_to_string(status));
-
     cairo_surface_destroy(image);
     cairo_destroy(cr);
 
     return;
 }
 
+std::vector<std::string> FrameBuffer::LoadAssetPack(std::string path) {
+    AssetPack *pack = new AssetPack(path[0] == '/' ? path : cwd + "/" + path);
+    std::lock_guard<std::mutex> lock(this->renderLock);
+
+    // packs loaded later take precedence
+    this->assetPacks.push_back(pack);
+
+    return pack->Names();
+}
+
+void FrameBuffer::AddOverlay(Overlay *overlay) {
+    std::lock_guard<std::mutex> lock(this->renderLock);
+    this->AllocateSnapshot();
+    this->overlays.push_back(overlay);
+
+    return;
+}
+
+void FrameBuffer::RemoveOverlay(Overlay *overlay) {
+    std::lock_guard<std::mutex> lock(this->renderLock);
+
+    for (size_t i = 0; i < this->overlays.size(); i++) {
+        if (this->overlays[i] == overlay) {
+            this->overlays.erase(this->overlays.begin() + i);
+            break;
+        }
+    }
+
+    return;
+}
+
+void FrameBuffer::PresentFrame() {
+    std::lock_guard<std::mutex> lock(this->renderLock);
+
+    // overlays go over what JS last blitted, a half drawn back buffer only reaches the screen on blit
+    if (this->drawToBuffer)
+        this->Composite();
+
+    return;
+}
+
+bool FrameBuffer::DoubleBuffered() { return this->drawToBuffer; }
+
+int FrameBuffer::BufferWidth() { return this->bufferWidth; }
+
+int FrameBuffer::BufferHeight() { return this->bufferHeight; }
+
+size_t FrameBuffer::BufferStride() { return cairo_format_stride_for_width(CAIRO_FORMAT_RGB16_565, this->bufferWidth); }
+
+char *FrameBuffer::AllocateBuffer(size_t size) {
+    void *buffer = nullptr;
+    // cache line aligned for SIMD, big buffers on huge page boundaries so THP can back them
+    size_t alignment = size >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : 64;
+
+    if (posix_memalign(&buffer, alignment, size) != 0)
+        throw std::runtime_error("Error allocating back buffer");
+
+#ifdef MADV_HUGEPAGE
+    if (size >= HUGE_PAGE_SIZE)
+        madvise(buffer, size, MADV_HUGEPAGE);
+#endif
+
+    memset(buffer, 0, size);
+
+    return (char *)buffer;
+}
+
+void FrameBuffer::AdoptBuffer(char *data, size_t length) {
+    if (!this->drawToBuffer)
+        throw std::runtime_error("Error sharing back buffer, needs double buffering");
+
+    if (length < this->bufferSize)
+        throw std::runtime_error("Error sharing back buffer, buffer too small");
+
+    // recorded draw calls still target the old buffer
+    this->Flush();
+
+    std::lock_guard<std::mutex> lock(this->renderLock);
+    cairo_surface_t *surface = cairo_image_surface_create_for_data((unsigned char *)data, CAIRO_FORMAT_RGB16_565,
+                                                                   this->bufferWidth, this->bufferHeight,
+                                                                   this->BufferStride());
+
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)
+        throw std::runtime_error("Error creating buffer surface");
+
+    cairo_surface_flush(this->bufferSurface);
+    memcpy(data, this->bbp, this->bufferSize);
+    cairo_surface_destroy(this->bufferSurface);
+
+    if (this->ownsBuffer)
+        free(this->bbp);
+
+    this->bufferSurface = surface;
+    this->bbp = data;
+    this->ownsBuffer = false;
+
+    return;
+}
+
+FrameBufferMemory FrameBuffer::Memory() {
+    FrameBufferMemory memory;
+
+    memory.screen = this->screenSize;
+    memory.backBuffer = this->bufferSize;
+    memory.sharedBackBuffer = !this->ownsBuffer;
+    memory.imageCache = Renderer::ImageCacheSize();
+    memory.assetPacks = 0;
+
+    std::lock_guard<std::mutex> lock(this->renderLock);
+    memory.presented = this->presentedSurface != nullptr ? this->bufferSize : 0;
+
+    for (size_t i = 0; i < this->assetPacks.size(); i++)
+        memory.assetPacks += this->assetPacks[i]->MappedSize();
+
+    return memory;
+}
+
+void FrameBuffer::QualityGovernor(double targetFps) {
+    // runs where frames are rasterized, so the counters stay with one thread
+    this->Run([=]() {
+        this->frameBudget = targetFps > 0 ? 1000.0 / targetFps : 0;
+        this->frameCost = 0;
+        this->frameWork = 0;
+        this->overBudget = this->underBudget = 0;
+
+        if (this->frameBudget == 0)
+            this->quality = 0;
+    });
+
+    return;
+}
+
+int FrameBuffer::QualityLevel() { return this->quality; }
+
+void FrameBuffer::Govern(double cost) {
+    this->frameWork = 0;
+
+    if (this->frameBudget == 0)
+        return;
+
+    this->frameCost = this->frameCost == 0 ? cost : this->frameCost * 0.8 + cost * 0.2;
+
+    // step down quickly when over budget, step up only after a long stretch with plenty of headroom
+    if (this->frameCost > this->frameBudget) {
+        this->underBudget = 0;
+
+        if (++this->overBudget >= 3 && this->quality < QUALITY_SOLID) {
+            this->quality++;
+            this->overBudget = 0;
+        }
+    } else if (this->frameCost < this->frameBudget * 0.6) {
+        this->overBudget = 0;
+
+        if (++this->underBudget >= 30 && this->quality > 0) {
+            this->quality--;
+            this->underBudget = 0;
+        }
+    } else
+        this->overBudget = this->underBudget = 0;
+
+    return;
+}
+
 cairo_t *FrameBuffer::getDrawingContext(FrameBuffer *obj) {
-    if (obj->drawToBuffer)
-        return cairo_create(obj->bufferSurface);
-    else
-        return cairo_create(obj->screenSurface);
+    cairo_t *cr;
+
+    if (obj->drawToBuffer) {
+        cr = cairo_create(obj->bufferSurface);
+
+        // callers keep drawing in screen coordinates at any internal resolution
+        if (obj->bufferScale != 1)
+            cairo_scale(cr, obj->bufferScale, obj->bufferScale);
+    } else
+        cr = cairo_create(obj->screenSurface);
+
+    // the governor's levels, text keeps its antialiasing to stay readable
+    if (obj->quality >= QUALITY_COARSE)
+        cairo_set_tolerance(cr, 0.5);
+    if (obj->quality >= QUALITY_ALIASED)
+        cairo_set_antialias(cr, CAIRO_ANTIALIAS_NONE);
+
+    return cr;
 }
 
 FrameBuffer::~FrameBuffer() {
+    if (worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(queueLock);
+            stopping = true;
+            queueCond.notify_all();
+        }
+
+        // queued frames are still drawn before the thread ends
+        worker.join();
+    }
+
     size_t patternSize = pattern.size();
     for (size_t i = 0; i < patternSize; i++)
         if (pattern[i] != nullptr)
             cairo_pattern_destroy(pattern[i]);
 
+    for (size_t i = 0; i < assetPacks.size(); i++)
+        delete assetPacks[i];
+
     if ((int)fbp != -1) {
-        free(bbp);
+        if (ownsBuffer)
+            free(bbp);
         munmap(fbp, screenSize);
 
         // if (ioctl(fbfd, FBIOPUT_VSCREENINFO, &orig_vinfo))
@@ -327,9 +1014,12 @@ FrameBuffer::~FrameBuffer() {
     if (fbfd != -1)
         close(fbfd);
 
-    if (cairo_surface_status(bufferSurface) == CAIRO_STATUS_SUCCESS)
+    if (bufferSurface != nullptr && cairo_surface_status(bufferSurface) == CAIRO_STATUS_SUCCESS)
         cairo_surface_destroy(bufferSurface);
 
+    if (presentedSurface != nullptr && cairo_surface_status(presentedSurface) == CAIRO_STATUS_SUCCESS)
+        cairo_surface_destroy(presentedSurface);
+
     if (cairo_surface_status(screenSurface) == CAIRO_STATUS_SUCCESS)
         cairo_surface_destroy(screenSurface);
 }
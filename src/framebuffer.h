@@ -11,16 +11,45 @@
 #include <sys/mman.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 #include <napi.h>
 
+#include "animation.h"
+#include "assetpack.h"
+#include "renderer.h"
+
 using namespace Napi;
 
+struct FrameBufferMemory {
+    size_t screen;
+    size_t backBuffer;
+    bool sharedBackBuffer;
+    size_t presented;
+    size_t imageCache;
+    size_t assetPacks;
+};
+
+struct RenderFrame {
+    std::vector<std::function<void()>> commands;
+    std::shared_ptr<SyncGroup> group;
+    bool present;
+};
+
 class FrameBuffer {
   public:
-    FrameBuffer(std::string cwd, const char *path, bool drawToBuffer);
+    FrameBuffer(std::string cwd, const char *path, bool drawToBuffer, bool threaded, double scale);
     ~FrameBuffer();
     void Clear();
     void Blit();
+    void Flush();
+    static void BlitSync(const std::vector<FrameBuffer *> &frameBuffers);
     void Color(double r, double g, double b);
     void Fill();
     void Line(double x0, double y0, double x1, double y1, double w);
@@ -29,10 +58,34 @@ class FrameBuffer {
     void Font(std::string fontName, double fontSize, bool fontBold);
     void Text(double x, double y, std::string text, bool textCentered, double textRotation, bool textRight);
     void Image(double x, double y, std::string path);
+    std::vector<std::string> LoadAssetPack(std::string path);
+    void AddOverlay(Overlay *overlay);
+    void RemoveOverlay(Overlay *overlay);
+    // repaints the last blitted frame with layers and overlays from any thread
+    void PresentFrame();
+    bool DoubleBuffered();
+    int BufferWidth();
+    int BufferHeight();
+    size_t BufferStride();
+    FrameBufferMemory Memory();
+    // moves the back buffer into caller owned memory (a SharedArrayBuffer), which must outlive the framebuffer
+    void AdoptBuffer(char *data, size_t length);
     size_t PatternCreateLinear(double arg0, double arg1, double arg2, double arg3, double arg4);
     size_t PatternCreateRGB(double arg0, double arg1, double arg2, double arg3, double arg4);
     void PatternAddColorStop(size_t patternIndex, double offset, double r, double g, double b, double alpha);
     void PatternDestroy(size_t patternIndex);
+    size_t LayerCreate(LayerType type);
+    bool GetLayer(size_t id, Layer &layer);
+    void LayerUpdate(size_t id, const Layer &layer);
+    void LayerDestroy(size_t id);
+    size_t Animate(size_t layer, std::vector<double Layer::*> properties, std::vector<double> from,
+                   std::vector<double> to, double duration, Easing easing, double now);
+    void AnimationStop(size_t id, bool jumpToEnd);
+    bool AnimationStep(double now, std::vector<std::pair<size_t, bool>> &finished);
+
+    // targetFps 0 turns the governor off and restores full quality
+    void QualityGovernor(double targetFps);
+    int QualityLevel();
 
     cairo_t *getDrawingContext(FrameBuffer *obj);
 
@@ -41,27 +94,82 @@ class FrameBuffer {
     struct fb_var_screeninfo vinfo;
 
   private:
+    void Run(std::function<void()> command);
+    void Submit(std::shared_ptr<SyncGroup> group, bool present);
+    void RenderLoop();
+    // called with queueLock held
+    void RethrowError();
+    void Present();
+    void Snapshot();
+    // called with renderLock held
+    void AllocateSnapshot();
+    void Composite();
+    void PresentRegion(const DamageRect &damage);
+    void PaintBuffer(cairo_t *cr);
+    static char *AllocateBuffer(size_t size);
+    void DrawImage(double x, double y, std::string path);
+    void Govern(double cost);
+    size_t PatternStore(size_t pos, cairo_pattern_t *created);
+
     int fbfd;
     struct fb_var_screeninfo orig_vinfo;
     struct fb_fix_screeninfo finfo;
 
     char *bbp;
+    bool ownsBuffer;
+    size_t bufferSize;
+    // the back buffer may be rendered at a fraction of the screen resolution
+    double bufferScale;
+    int bufferWidth;
+    int bufferHeight;
 
     cairo_surface_t *bufferSurface;
     cairo_surface_t *screenSurface;
+    // copy of the back buffer taken at the last blit, repainted under layers and overlays between blits, only
+    // allocated once the first layer or overlay is added
+    cairo_surface_t *presentedSurface;
 
     double r, g, b;
 
     std::vector<cairo_pattern_t *> pattern;
     size_t usedPattern;
     bool usePattern;
+    size_t patternSlots;
 
-    const char *fontName;
+    std::string fontName;
     double fontSize;
     bool fontBold;
 
     bool drawToBuffer;
 
+    Animator animator;
+
+    std::vector<AssetPack *> assetPacks;
+
+    std::vector<Overlay *> overlays;
+
+    // quality governor, frame costs are in milliseconds and only touched by the thread that rasterizes
+    double frameBudget;
+    double frameCost;
+    double frameWork;
+    int overBudget;
+    int underBudget;
+    std::atomic<int> quality;
+
+    // render thread, only used when threaded
+    bool threaded;
+    std::thread worker;
+    std::vector<std::function<void()>> recording;
+    std::deque<RenderFrame> frames;
+    std::mutex queueLock;
+    std::condition_variable queueCond;
+    bool stopping;
+    bool busy;
+    std::string renderError;
+
+    // held while a frame is rasterized or presented, and by anything touching layers or packs from JS
+    std::mutex renderLock;
+
     std::string cwd;
 };
 
@@ -1,7 +1,25 @@
 #include "framebufferWrapper.h"
+#include "options.h"
+
+#include <math.h>
 
 Napi::FunctionReference FrameBufferWrapper::constructor;
 
+// Warms the shared font and image caches on the libuv thread pool, then settles the ready() promises.
+class PreloadWorker : public Napi::AsyncWorker {
+  public:
+    PreloadWorker(Napi::Env env, FrameBufferWrapper *wrapper, PreloadManifest manifest)
+        : Napi::AsyncWorker(env, "pitft preload"), wrapper_(wrapper), manifest_(manifest) {}
+
+    void Execute() { this->error_ = Renderer::Preload(this->manifest_); }
+    void OnOK() { this->wrapper_->PreloadDone(this->error_); }
+
+  private:
+    FrameBufferWrapper *wrapper_;
+    PreloadManifest manifest_;
+    std::string error_;
+};
+
 Napi::Object FrameBufferWrapper::Init(Napi::Env env, Napi::Object exports) {
     Napi::HandleScope scope(env);
 
@@ -10,8 +28,11 @@ Napi::Object FrameBufferWrapper::Init(Napi::Env env, Napi::Object exports) {
         // clang-format off
         {InstanceMethod("size", &FrameBufferWrapper::Size),
          InstanceMethod("data", &FrameBufferWrapper::Data),
+         InstanceMethod("sharedBuffer", &FrameBufferWrapper::SharedBuffer),
+         InstanceMethod("memory", &FrameBufferWrapper::Memory),
          InstanceMethod("clear", &FrameBufferWrapper::Clear),
          InstanceMethod("blit", &FrameBufferWrapper::Blit),
+         InstanceMethod("flush", &FrameBufferWrapper::Flush),
          InstanceMethod("color", &FrameBufferWrapper::Color),
          InstanceMethod("fill", &FrameBufferWrapper::Fill),
          InstanceMethod("line", &FrameBufferWrapper::Line),
@@ -20,10 +41,25 @@ Napi::Object FrameBufferWrapper::Init(Napi::Env env, Napi::Object exports) {
          InstanceMethod("font", &FrameBufferWrapper::Font),
          InstanceMethod("text", &FrameBufferWrapper::Text),
          InstanceMethod("image", &FrameBufferWrapper::Image),
+         InstanceMethod("assetPack", &FrameBufferWrapper::AssetPack),
          InstanceMethod("patternCreateLinear", &FrameBufferWrapper::PatternCreateLinear),
          InstanceMethod("patternCreateRGB", &FrameBufferWrapper::PatternCreateRGB),
          InstanceMethod("patternAddColorStop", &FrameBufferWrapper::PatternAddColorStop),
-         InstanceMethod("patternDestroy", &FrameBufferWrapper::PatternDestroy)});
+         InstanceMethod("patternDestroy", &FrameBufferWrapper::PatternDestroy),
+         InstanceMethod("layerCreate", &FrameBufferWrapper::LayerCreate),
+         InstanceMethod("layerSet", &FrameBufferWrapper::LayerSet),
+         InstanceMethod("layerDestroy", &FrameBufferWrapper::LayerDestroy),
+         InstanceMethod("animate", &FrameBufferWrapper::Animate),
+         InstanceMethod("animationStop", &FrameBufferWrapper::AnimationStop),
+         InstanceMethod("animationFrameRate", &FrameBufferWrapper::AnimationFrameRate),
+         InstanceMethod("serverStart", &FrameBufferWrapper::ServerStart),
+         InstanceMethod("serverStop", &FrameBufferWrapper::ServerStop),
+         InstanceMethod("serverClients", &FrameBufferWrapper::ServerClients),
+         InstanceMethod("qualityGovernor", &FrameBufferWrapper::QualityGovernor),
+         InstanceMethod("qualityLevel", &FrameBufferWrapper::QualityLevel),
+         InstanceMethod("ready", &FrameBufferWrapper::Ready),
+         StaticMethod("blitSync", &FrameBufferWrapper::BlitSync),
+         StaticMethod("clearCaches", &FrameBufferWrapper::ClearCaches)});
     // clang-format on
 
     constructor = Napi::Persistent(func);
@@ -45,17 +81,69 @@ FrameBufferWrapper::FrameBufferWrapper(const Napi::CallbackInfo &info) : Napi::O
     // JS execution path
     std::string cwd = info[0].As<Napi::String>().Utf8Value();
     // framebuffer device path
-    const char *path = info[1].As<Napi::String>().Utf8Value().c_str();
+    std::string path = info[1].As<Napi::String>().Utf8Value();
     bool drawToBuffer = false;
+    bool threaded = false;
 
-    if (info.Length() == 3) {
+    if (info.Length() >= 3 && !info[2].IsUndefined()) {
         if (!info[2].IsBoolean())
             Napi::TypeError::New(env, "expected boolean");
         else
             drawToBuffer = info[2].As<Napi::Boolean>().Value();
     }
 
-    this->frameBufferClass_ = new FrameBuffer(cwd, path, drawToBuffer);
+    // options, threaded: true gives the panel its own render thread, preload lists fonts and images to warm,
+    // scale renders the back buffer at a fraction of the screen resolution
+    PreloadManifest manifest;
+    double scale = 1;
+
+    if (info[3].IsObject()) {
+        Napi::Object options = info[3].As<Napi::Object>();
+
+        threaded = OptionBoolean(options, "threaded", false);
+        scale = OptionNumber(options, "scale", 1);
+
+        if (options.Has("preload") && options.Get("preload").IsObject())
+            manifest = ReadManifest(options.Get("preload").As<Napi::Object>(), cwd);
+    }
+
+    this->env_ = env;
+    this->animationTimer_ = nullptr;
+    this->animationInterval_ = 16;
+    this->renderServer_ = nullptr;
+    this->lastQuality_ = 0;
+
+    this->preloading_ = false;
+    this->frameBufferClass_ = nullptr;
+
+    try {
+        this->frameBufferClass_ = new FrameBuffer(cwd, path.c_str(), drawToBuffer, threaded, scale);
+    } catch (const std::exception &e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return;
+    }
+
+    if (!manifest.fonts.empty() || !manifest.images.empty()) {
+        // reserved right away, so a draw issued before the worker gets going waits for it instead of racing it
+        Renderer::Reserve(manifest);
+
+        this->preloading_ = true;
+        // the framebuffer must outlive the worker
+        this->Ref();
+
+        (new PreloadWorker(env, this, manifest))->Queue();
+    }
+}
+
+FrameBufferWrapper::~FrameBufferWrapper() {
+    if (this->animationTimer_ != nullptr) {
+        uv_timer_stop(this->animationTimer_);
+        uv_close((uv_handle_t *)this->animationTimer_, [](uv_handle_t *handle) { delete (uv_timer_t *)handle; });
+    }
+
+    // the server presents through the framebuffer, it goes first
+    delete this->renderServer_;
+    delete this->frameBufferClass_;
 }
 
 Napi::Value FrameBufferWrapper::Size(const Napi::CallbackInfo &info) {
@@ -78,6 +166,58 @@ Napi::Value FrameBufferWrapper::Data(const Napi::CallbackInfo &info) {
     return bufferObject;
 }
 
+Napi::Value FrameBufferWrapper::SharedBuffer(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    if (!this->sharedHandle_.IsEmpty())
+        return this->sharedHandle_.Value();
+
+    // N-API cannot wrap native memory in a SharedArrayBuffer, so JS allocates it and the back buffer moves in
+    size_t size = this->frameBufferClass_->BufferStride() * this->frameBufferClass_->BufferHeight();
+    Napi::Function sharedArrayBuffer = env.Global().Get("SharedArrayBuffer").As<Napi::Function>();
+    Napi::Object buffer = sharedArrayBuffer.New({Napi::Number::New(env, size)});
+    Napi::Object sync = sharedArrayBuffer.New({Napi::Number::New(env, 2 * sizeof(int32_t))});
+    Napi::Uint8Array bytes = env.Global().Get("Uint8Array").As<Napi::Function>().New({buffer}).As<Napi::Uint8Array>();
+
+    try {
+        this->frameBufferClass_->AdoptBuffer((char *)bytes.Data(), bytes.ByteLength());
+    } catch (const std::exception &e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Object handle = Napi::Object::New(env);
+
+    handle.Set("buffer", buffer);
+    handle.Set("sync", env.Global().Get("Int32Array").As<Napi::Function>().New({sync}));
+    // the buffer's own size, smaller than the screen when the scale option is used
+    handle.Set("width", this->frameBufferClass_->BufferWidth());
+    handle.Set("height", this->frameBufferClass_->BufferHeight());
+    handle.Set("stride", this->frameBufferClass_->BufferStride());
+    handle.Set("format", "rgb565");
+
+    this->sharedHandle_ = Napi::Persistent(handle);
+
+    return handle;
+}
+
+Napi::Value FrameBufferWrapper::Memory(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+    FrameBufferMemory memory = this->frameBufferClass_->Memory();
+    Napi::Object memoryObject = Napi::Object::New(env);
+
+    memoryObject.Set("screen", (double)memory.screen);
+    memoryObject.Set("backBuffer", (double)memory.backBuffer);
+    memoryObject.Set("sharedBackBuffer", memory.sharedBackBuffer);
+    memoryObject.Set("presented", (double)memory.presented);
+    memoryObject.Set("imageCache", (double)memory.imageCache);
+    memoryObject.Set("assetPacks", (double)memory.assetPacks);
+
+    return memoryObject;
+}
+
 void FrameBufferWrapper::Clear(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
     Napi::HandleScope scope(env);
@@ -91,11 +231,81 @@ void FrameBufferWrapper::Blit(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
     Napi::HandleScope scope(env);
 
-    this->frameBufferClass_->Blit();
+    try {
+        this->frameBufferClass_->Blit();
+    } catch (const std::exception &e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return;
+    }
+
+    // threaded panels settle their level on the render thread, it is reported on a later blit
+    int level = this->frameBufferClass_->QualityLevel();
+
+    if (level != this->lastQuality_) {
+        this->lastQuality_ = level;
+
+        if (!this->qualityCallback_.IsEmpty())
+            this->qualityCallback_.Call({Napi::Number::New(env, level)});
+    }
 
     return;
 }
 
+void FrameBufferWrapper::Flush(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    try {
+        this->frameBufferClass_->Flush();
+    } catch (const std::exception &e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+
+    return;
+}
+
+Napi::Value FrameBufferWrapper::BlitSync(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+    std::vector<FrameBuffer *> frameBuffers;
+
+    if (!info[0].IsArray()) {
+        Napi::TypeError::New(env, "expected an array of framebuffers").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Array list = info[0].As<Napi::Array>();
+
+    for (uint32_t i = 0; i < list.Length(); i++) {
+        Napi::Value item = list.Get(i);
+
+        // Unwrap trusts any object, only framebuffers carry a FrameBufferWrapper
+        if (!item.IsObject() || !item.As<Napi::Object>().InstanceOf(constructor.Value())) {
+            Napi::TypeError::New(env, "invalid argument").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+
+        frameBuffers.push_back(FrameBufferWrapper::Unwrap(item.As<Napi::Object>())->frameBufferClass_);
+    }
+
+    try {
+        FrameBuffer::BlitSync(frameBuffers);
+    } catch (const std::exception &e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+
+    return env.Undefined();
+}
+
+Napi::Value FrameBufferWrapper::ClearCaches(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    Renderer::ClearCaches();
+
+    return env.Undefined();
+}
+
 void FrameBufferWrapper::Color(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
     Napi::HandleScope scope(env);
@@ -112,6 +322,184 @@ void FrameBufferWrapper::Color(const Napi::CallbackInfo &info) {
     return;
 }
 
+Napi::Value FrameBufferWrapper::AssetPack(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    if (info.Length() != 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "invalid argument").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    try {
+        std::vector<std::string> names = this->frameBufferClass_->LoadAssetPack(info[0].As<Napi::String>().Utf8Value());
+        Napi::Array namesArray = Napi::Array::New(env, names.size());
+
+        for (size_t i = 0; i < names.size(); i++)
+            namesArray.Set(i, names[i]);
+
+        return namesArray;
+    } catch (const std::exception &e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+}
+
+void FrameBufferWrapper::ServerStart(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "expected socket path").ThrowAsJavaScriptException();
+        return;
+    }
+
+    if (this->renderServer_ != nullptr) {
+        Napi::Error::New(env, "render server already running").ThrowAsJavaScriptException();
+        return;
+    }
+
+    // options, fps caps how often client commits reach the screen
+    double fps = 60;
+
+    if (info.Length() >= 2 && info[1].IsObject())
+        fps = OptionNumber(info[1].As<Napi::Object>(), "fps", 60);
+
+    try {
+        this->renderServer_ = new RenderServer(this->frameBufferClass_, info[0].As<Napi::String>().Utf8Value(), fps);
+    } catch (const std::exception &e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+
+    return;
+}
+
+void FrameBufferWrapper::ServerStop(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    delete this->renderServer_;
+    this->renderServer_ = nullptr;
+
+    return;
+}
+
+Napi::Value FrameBufferWrapper::ServerClients(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    return Napi::Number::New(env, this->renderServer_ != nullptr ? this->renderServer_->Clients() : 0);
+}
+
+void FrameBufferWrapper::QualityGovernor(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+    double targetFps = 0;
+
+    // target frame rate, false or 0 turns the governor off
+    if (info[0].IsNumber())
+        targetFps = info[0].As<Napi::Number>().DoubleValue();
+    else if (!info[0].IsBoolean() || info[0].As<Napi::Boolean>().Value()) {
+        Napi::TypeError::New(env, "expected frame rate or false").ThrowAsJavaScriptException();
+        return;
+    }
+
+    if (info[1].IsFunction())
+        this->qualityCallback_ = Napi::Persistent(info[1].As<Napi::Function>());
+    else
+        this->qualityCallback_.Reset();
+
+    this->frameBufferClass_->QualityGovernor(targetFps);
+
+    return;
+}
+
+Napi::Value FrameBufferWrapper::QualityLevel(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    return Napi::Number::New(env, this->frameBufferClass_->QualityLevel());
+}
+
+PreloadManifest FrameBufferWrapper::ReadManifest(Napi::Object preload, const std::string &cwd) {
+    PreloadManifest manifest;
+
+    if (preload.Has("fonts") && preload.Get("fonts").IsArray()) {
+        Napi::Array fonts = preload.Get("fonts").As<Napi::Array>();
+
+        for (uint32_t i = 0; i < fonts.Length(); i++) {
+            if (!fonts.Get(i).IsObject())
+                continue;
+
+            Napi::Object font = fonts.Get(i).As<Napi::Object>();
+            std::string name = OptionString(font, "name", "Sans");
+            bool bold = OptionBoolean(font, "bold", false);
+            double size = OptionNumber(font, "size", 12);
+            size_t f = 0;
+
+            // one entry per face, with all the sizes asked for
+            while (f < manifest.fonts.size() && (manifest.fonts[f].name != name || manifest.fonts[f].bold != bold))
+                f++;
+
+            if (f == manifest.fonts.size())
+                manifest.fonts.push_back(PreloadFont{name, bold, {}});
+
+            manifest.fonts[f].sizes.push_back(size);
+        }
+    }
+
+    if (preload.Has("images") && preload.Get("images").IsArray()) {
+        Napi::Array images = preload.Get("images").As<Napi::Array>();
+
+        // resolved the way image() resolves them, so draws find them in the cache
+        for (uint32_t i = 0; i < images.Length(); i++)
+            if (images.Get(i).IsString())
+                manifest.images.push_back(cwd + "/" + images.Get(i).As<Napi::String>().Utf8Value());
+    }
+
+    return manifest;
+}
+
+void FrameBufferWrapper::PreloadDone(const std::string &error) {
+    Napi::Env env(this->env_);
+    Napi::HandleScope scope(env);
+
+    this->preloading_ = false;
+    this->preloadError_ = error;
+
+    for (size_t i = 0; i < this->readyDeferreds_.size(); i++)
+        this->Settle(this->readyDeferreds_[i]);
+
+    this->readyDeferreds_.clear();
+    this->Unref();
+
+    return;
+}
+
+void FrameBufferWrapper::Settle(Napi::Promise::Deferred deferred) {
+    Napi::Env env = deferred.Env();
+
+    if (this->preloadError_.empty())
+        deferred.Resolve(env.Undefined());
+    else
+        deferred.Reject(Napi::Error::New(env, this->preloadError_).Value());
+
+    return;
+}
+
+Napi::Value FrameBufferWrapper::Ready(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+
+    if (this->preloading_)
+        this->readyDeferreds_.push_back(deferred);
+    else
+        this->Settle(deferred);
+
+    return deferred.Promise();
+}
+
 Napi::Value FrameBufferWrapper::PatternCreateLinear(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
     Napi::HandleScope scope(env);
@@ -404,3 +792,303 @@ void FrameBufferWrapper::Image(const Napi::CallbackInfo &info) {
 
     return;
 }
+
+void FrameBufferWrapper::ApplyLayerProperties(Layer &layer, Napi::Object properties) {
+    Napi::Array names = properties.GetPropertyNames();
+
+    for (uint32_t i = 0; i < names.Length(); i++) {
+        std::string name = names.Get(i).As<Napi::String>().Utf8Value();
+        double Layer::*property = Animator::Property(name);
+
+        if (property != nullptr && properties.Get(name).IsNumber())
+            layer.*property = properties.Get(name).As<Napi::Number>().DoubleValue();
+    }
+
+    layer.visible = OptionBoolean(properties, "visible", layer.visible);
+    layer.filled = OptionBoolean(properties, "filled", layer.filled);
+    layer.centered = OptionBoolean(properties, "centered", layer.centered);
+    layer.fontBold = OptionBoolean(properties, "bold", layer.fontBold);
+    layer.text = OptionString(properties, "text", layer.text);
+    layer.fontName = OptionString(properties, "font", layer.fontName);
+    layer.path = OptionString(properties, "path", layer.path);
+
+    return;
+}
+
+Napi::Value FrameBufferWrapper::LayerCreate(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+    LayerType type;
+
+    if (!info[0].IsString()) {
+        Napi::TypeError::New(env, "invalid argument").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    std::string typeName = info[0].As<Napi::String>().Utf8Value();
+
+    if (typeName == "rect")
+        type = LAYER_RECT;
+    else if (typeName == "circle")
+        type = LAYER_CIRCLE;
+    else if (typeName == "line")
+        type = LAYER_LINE;
+    else if (typeName == "text")
+        type = LAYER_TEXT;
+    else if (typeName == "image")
+        type = LAYER_IMAGE;
+    else {
+        Napi::TypeError::New(env, "invalid layer type").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    size_t id;
+
+    try {
+        id = this->frameBufferClass_->LayerCreate(type);
+    } catch (const std::exception &e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    if (!info[1].IsObject())
+        return Napi::Number::New(env, id);
+
+    try {
+        Layer layer;
+        this->frameBufferClass_->GetLayer(id, layer);
+        ApplyLayerProperties(layer, info[1].As<Napi::Object>());
+
+        // a throwing property getter leaves a pending exception instead of a C++ one
+        if (!env.IsExceptionPending())
+            this->frameBufferClass_->LayerUpdate(id, layer);
+    } catch (const std::exception &e) {
+        // the caller never sees the id, so the layer must not outlive the failed call
+        this->frameBufferClass_->LayerDestroy(id);
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    if (env.IsExceptionPending()) {
+        this->frameBufferClass_->LayerDestroy(id);
+        return env.Undefined();
+    }
+
+    return Napi::Number::New(env, id);
+}
+
+void FrameBufferWrapper::LayerSet(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    if (!info[0].IsNumber() || !info[1].IsObject()) {
+        Napi::TypeError::New(env, "invalid argument").ThrowAsJavaScriptException();
+        return;
+    }
+
+    size_t id = info[0].As<Napi::Number>().Uint32Value();
+    Layer layer;
+
+    if (!this->frameBufferClass_->GetLayer(id, layer)) {
+        Napi::Error::New(env, "Error using layer, layer not exists").ThrowAsJavaScriptException();
+        return;
+    }
+
+    ApplyLayerProperties(layer, info[1].As<Napi::Object>());
+
+    // a throwing property getter leaves a pending exception, the layer keeps its old properties
+    if (env.IsExceptionPending())
+        return;
+
+    try {
+        this->frameBufferClass_->LayerUpdate(id, layer);
+    } catch (const std::exception &e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+
+    return;
+}
+
+void FrameBufferWrapper::LayerDestroy(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    if (info.Length() == 1 && info[0].IsNumber()) {
+        this->frameBufferClass_->LayerDestroy(info[0].As<Napi::Number>().Uint32Value());
+        // running animations on the layer are cancelled, let their callbacks fire
+        this->StartAnimationTimer();
+    } else
+        Napi::TypeError::New(env, "invalid argument").ThrowAsJavaScriptException();
+
+    return;
+}
+
+Napi::Value FrameBufferWrapper::Animate(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+    std::vector<double Layer::*> properties;
+    std::vector<double> from, to;
+    Easing easing = EASE_LINEAR;
+
+    if (!info[0].IsNumber() || !info[1].IsString() || !info[4].IsNumber()) {
+        Napi::TypeError::New(env, "invalid argument").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    std::string name = info[1].As<Napi::String>().Utf8Value();
+
+    if (name == "color") {
+        // colors tween as [r, g, b]
+        properties = {&Layer::r, &Layer::g, &Layer::b};
+
+        if (!info[3].IsArray() || info[3].As<Napi::Array>().Length() != 3 ||
+            !(info[2].IsNull() || info[2].IsUndefined() ||
+              (info[2].IsArray() && info[2].As<Napi::Array>().Length() == 3))) {
+            Napi::TypeError::New(env, "invalid color, expected [r, g, b]").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+
+        for (uint32_t i = 0; i < 3; i++) {
+            to.push_back(info[3].As<Napi::Array>().Get(i).ToNumber().DoubleValue());
+            from.push_back(info[2].IsArray() ? info[2].As<Napi::Array>().Get(i).ToNumber().DoubleValue() : NAN);
+        }
+    } else {
+        double Layer::*property = Animator::Property(name);
+
+        if (property == nullptr || !info[3].IsNumber() ||
+            !(info[2].IsNull() || info[2].IsUndefined() || info[2].IsNumber())) {
+            Napi::TypeError::New(env, "invalid property").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+
+        properties.push_back(property);
+        to.push_back(info[3].As<Napi::Number>().DoubleValue());
+        from.push_back(info[2].IsNumber() ? info[2].As<Napi::Number>().DoubleValue() : NAN);
+    }
+
+    if (info[5].IsString()) {
+        std::string easingName = info[5].As<Napi::String>().Utf8Value();
+
+        if (easingName == "easeIn")
+            easing = EASE_IN;
+        else if (easingName == "easeOut")
+            easing = EASE_OUT;
+        else if (easingName == "easeInOut")
+            easing = EASE_IN_OUT;
+        else if (easingName == "easeOutBack")
+            easing = EASE_OUT_BACK;
+        else if (easingName == "easeOutBounce")
+            easing = EASE_OUT_BOUNCE;
+        else if (easingName != "linear") {
+            Napi::TypeError::New(env, "invalid easing").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+    }
+
+    size_t id;
+
+    try {
+        // clang-format off
+        id = this->frameBufferClass_->Animate(
+            info[0].As<Napi::Number>().Uint32Value(),
+            properties, from, to,
+            info[4].As<Napi::Number>().DoubleValue(),
+            easing, uv_hrtime() / 1e6);
+        // clang-format on
+    } catch (const std::exception &e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Value callback = info[6].IsFunction() ? info[6] : info[5];
+
+    if (callback.IsFunction())
+        this->animationCallbacks_[id] = Napi::Persistent(callback.As<Napi::Function>());
+
+    this->StartAnimationTimer();
+
+    return Napi::Number::New(env, id);
+}
+
+void FrameBufferWrapper::AnimationStop(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+    bool jumpToEnd = false;
+
+    if (!info[1].IsUndefined()) {
+        if (info[1].IsBoolean())
+            jumpToEnd = info[1].As<Napi::Boolean>().Value();
+        else
+            Napi::TypeError::New(env, "invalid jump to end argument").ThrowAsJavaScriptException();
+    }
+
+    if (info[0].IsNumber()) {
+        this->frameBufferClass_->AnimationStop(info[0].As<Napi::Number>().Uint32Value(), jumpToEnd);
+        this->StartAnimationTimer();
+    } else
+        Napi::TypeError::New(env, "invalid argument").ThrowAsJavaScriptException();
+
+    return;
+}
+
+void FrameBufferWrapper::AnimationFrameRate(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    if (info.Length() == 1 && info[0].IsNumber() && info[0].As<Napi::Number>().DoubleValue() > 0)
+        this->animationInterval_ = 1000 / info[0].As<Napi::Number>().DoubleValue();
+    else
+        Napi::TypeError::New(env, "invalid argument").ThrowAsJavaScriptException();
+
+    if (this->animationInterval_ < 1)
+        this->animationInterval_ = 1;
+
+    // pick up the new rate on the next start
+    if (this->animationTimer_ != nullptr && uv_is_active((uv_handle_t *)this->animationTimer_)) {
+        uv_timer_stop(this->animationTimer_);
+        this->StartAnimationTimer();
+    }
+
+    return;
+}
+
+void FrameBufferWrapper::StartAnimationTimer() {
+    if (this->animationTimer_ == nullptr) {
+        uv_loop_t *loop;
+        napi_get_uv_event_loop(this->env_, &loop);
+
+        this->animationTimer_ = new uv_timer_t;
+        uv_timer_init(loop, this->animationTimer_);
+        this->animationTimer_->data = this;
+    }
+
+    if (!uv_is_active((uv_handle_t *)this->animationTimer_))
+        uv_timer_start(this->animationTimer_, OnAnimationFrame, 0, this->animationInterval_);
+
+    return;
+}
+
+void FrameBufferWrapper::OnAnimationFrame(uv_timer_t *handle) {
+    FrameBufferWrapper *wrapper = (FrameBufferWrapper *)handle->data;
+    Napi::Env env(wrapper->env_);
+    Napi::HandleScope scope(env);
+    std::vector<std::pair<size_t, bool>> finished;
+
+    // advancing, re-rendering and presenting the damaged area is all native, JS only hears about completions
+    if (!wrapper->frameBufferClass_->AnimationStep(uv_hrtime() / 1e6, finished))
+        uv_timer_stop(handle);
+
+    for (size_t i = 0; i < finished.size(); i++) {
+        auto it = wrapper->animationCallbacks_.find(finished[i].first);
+
+        if (it == wrapper->animationCallbacks_.end())
+            continue;
+
+        Napi::FunctionReference callback = std::move(it->second);
+        wrapper->animationCallbacks_.erase(it);
+
+        callback.MakeCallback(env.Global(), {Napi::Boolean::New(env, finished[i].second)});
+    }
+
+    return;
+}
@@ -2,18 +2,25 @@
 #define FRAMEBUFFERWRAPPER_H
 
 #include "framebuffer.h"
+#include "renderserver.h"
+#include <map>
 #include <napi.h>
+#include <uv.h>
 
 class FrameBufferWrapper : public Napi::ObjectWrap<FrameBufferWrapper> {
+    friend class PreloadWorker;
+
   public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
     FrameBufferWrapper(const Napi::CallbackInfo &info);
+    ~FrameBufferWrapper();
 
   private:
     static Napi::FunctionReference constructor;
 
     void Clear(const Napi::CallbackInfo &info);
     void Blit(const Napi::CallbackInfo &info);
+    void Flush(const Napi::CallbackInfo &info);
     void Color(const Napi::CallbackInfo &info);
     void Fill(const Napi::CallbackInfo &info);
     void Line(const Napi::CallbackInfo &info);
@@ -24,13 +31,53 @@ class FrameBufferWrapper : public Napi::ObjectWrap<FrameBufferWrapper> {
     void Image(const Napi::CallbackInfo &info);
     void PatternAddColorStop(const Napi::CallbackInfo &info);
     void PatternDestroy(const Napi::CallbackInfo &info);
+    void LayerSet(const Napi::CallbackInfo &info);
+    void LayerDestroy(const Napi::CallbackInfo &info);
+    void AnimationStop(const Napi::CallbackInfo &info);
+    void AnimationFrameRate(const Napi::CallbackInfo &info);
+    void ServerStart(const Napi::CallbackInfo &info);
+    void ServerStop(const Napi::CallbackInfo &info);
+    void QualityGovernor(const Napi::CallbackInfo &info);
 
     Napi::Value Size(const Napi::CallbackInfo &info);
     Napi::Value Data(const Napi::CallbackInfo &info);
+    Napi::Value SharedBuffer(const Napi::CallbackInfo &info);
+    Napi::Value Memory(const Napi::CallbackInfo &info);
     Napi::Value PatternCreateLinear(const Napi::CallbackInfo &info);
     Napi::Value PatternCreateRGB(const Napi::CallbackInfo &info);
+    Napi::Value LayerCreate(const Napi::CallbackInfo &info);
+    Napi::Value Animate(const Napi::CallbackInfo &info);
+    Napi::Value AssetPack(const Napi::CallbackInfo &info);
+    Napi::Value ServerClients(const Napi::CallbackInfo &info);
+    Napi::Value QualityLevel(const Napi::CallbackInfo &info);
+    Napi::Value Ready(const Napi::CallbackInfo &info);
+
+    static Napi::Value BlitSync(const Napi::CallbackInfo &info);
+    static Napi::Value ClearCaches(const Napi::CallbackInfo &info);
+
+    static void ApplyLayerProperties(Layer &layer, Napi::Object properties);
+    static void OnAnimationFrame(uv_timer_t *handle);
+    void StartAnimationTimer();
+    static PreloadManifest ReadManifest(Napi::Object preload, const std::string &cwd);
+    void PreloadDone(const std::string &error);
+    void Settle(Napi::Promise::Deferred deferred);
 
     FrameBuffer *frameBufferClass_;
+    RenderServer *renderServer_;
+    // the shared back buffer handle, also keeps the SharedArrayBuffer alive
+    Napi::ObjectReference sharedHandle_;
+
+    napi_env env_;
+    uv_timer_t *animationTimer_;
+    uint64_t animationInterval_;
+    std::map<size_t, Napi::FunctionReference> animationCallbacks_;
+
+    Napi::FunctionReference qualityCallback_;
+    int lastQuality_;
+
+    bool preloading_;
+    std::string preloadError_;
+    std::vector<Napi::Promise::Deferred> readyDeferreds_;
 };
 
 #endif
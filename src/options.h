@@ -0,0 +1,30 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <napi.h>
+
+// Helpers for reading optional fields out of a JS options object, falling back to a default when the field is
+// missing or has the wrong type.
+
+inline double OptionNumber(Napi::Object options, const char *name, double fallback) {
+    if (options.Has(name) && options.Get(name).IsNumber())
+        return options.Get(name).As<Napi::Number>().DoubleValue();
+
+    return fallback;
+}
+
+inline bool OptionBoolean(Napi::Object options, const char *name, bool fallback) {
+    if (options.Has(name) && options.Get(name).IsBoolean())
+        return options.Get(name).As<Napi::Boolean>().Value();
+
+    return fallback;
+}
+
+inline std::string OptionString(Napi::Object options, const char *name, std::string fallback) {
+    if (options.Has(name) && options.Get(name).IsString())
+        return options.Get(name).As<Napi::String>().Utf8Value();
+
+    return fallback;
+}
+
+#endif
@@ -1,6 +1,16 @@
+#include "assetpackWrapper.h"
 #include "framebufferWrapper.h"
+#include "renderclientWrapper.h"
+#include "touchscreenWrapper.h"
 #include <napi.h>
 
-Napi::Object InitAll(Napi::Env env, Napi::Object exports) { return FrameBufferWrapper::Init(env, exports); }
+Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
+    FrameBufferWrapper::Init(env, exports);
+    TouchScreenWrapper::Init(env, exports);
+    AssetPackWrapper::Init(env, exports);
+    RenderClientWrapper::Init(env, exports);
+
+    return exports;
+}
 
 NODE_API_MODULE(NODE_GYP_MODULE_NAME, InitAll);
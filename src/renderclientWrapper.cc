@@ -0,0 +1,308 @@
+#include "renderclientWrapper.h"
+
+Napi::FunctionReference RenderClientWrapper::constructor;
+
+Napi::Object RenderClientWrapper::Init(Napi::Env env, Napi::Object exports) {
+    Napi::HandleScope scope(env);
+
+    Napi::Function func = DefineClass(
+        env, "RenderClientWrapper",
+        // clang-format off
+        {InstanceMethod("size", &RenderClientWrapper::Size),
+         InstanceMethod("clear", &RenderClientWrapper::Clear),
+         InstanceMethod("color", &RenderClientWrapper::Color),
+         InstanceMethod("fill", &RenderClientWrapper::Fill),
+         InstanceMethod("rect", &RenderClientWrapper::Rect),
+         InstanceMethod("line", &RenderClientWrapper::Line),
+         InstanceMethod("circle", &RenderClientWrapper::Circle),
+         InstanceMethod("font", &RenderClientWrapper::Font),
+         InstanceMethod("text", &RenderClientWrapper::Text),
+         InstanceMethod("pixels", &RenderClientWrapper::Pixels),
+         InstanceMethod("z", &RenderClientWrapper::Z),
+         InstanceMethod("commit", &RenderClientWrapper::Commit),
+         InstanceMethod("close", &RenderClientWrapper::Close)});
+    // clang-format on
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("RenderClient", func);
+
+    return exports;
+}
+
+RenderClientWrapper::RenderClientWrapper(const Napi::CallbackInfo &info)
+    : Napi::ObjectWrap<RenderClientWrapper>(info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    this->renderClientClass_ = nullptr;
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "expected socket path").ThrowAsJavaScriptException();
+        return;
+    }
+
+    try {
+        this->renderClientClass_ = new RenderClient(info[0].As<Napi::String>().Utf8Value());
+    } catch (const std::exception &e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+}
+
+RenderClientWrapper::~RenderClientWrapper() { delete this->renderClientClass_; }
+
+void RenderClientWrapper::Send(Napi::Env env, RenderOp op, std::vector<float> args, const std::string &data) {
+    if (this->renderClientClass_ == nullptr) {
+        Napi::Error::New(env, "render client closed").ThrowAsJavaScriptException();
+        return;
+    }
+
+    try {
+        // strings go over with their terminator so the server can bound them
+        this->renderClientClass_->Write(op, args.data(), args.size(), data.c_str(), data.empty() ? 0 : data.size() + 1);
+    } catch (const std::exception &e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+
+    return;
+}
+
+Napi::Value RenderClientWrapper::Size(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+    Napi::Object sizeObject = Napi::Object::New(env);
+
+    sizeObject.Set("width", this->renderClientClass_ != nullptr ? this->renderClientClass_->width : 0);
+    sizeObject.Set("height", this->renderClientClass_ != nullptr ? this->renderClientClass_->height : 0);
+
+    return sizeObject;
+}
+
+void RenderClientWrapper::Clear(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    this->Send(env, RENDER_CLEAR, {}, "");
+
+    return;
+}
+
+void RenderClientWrapper::Color(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    if (!info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber()) {
+        Napi::TypeError::New(env, "invalid argument").ThrowAsJavaScriptException();
+        return;
+    }
+
+    // clang-format off
+    this->Send(env, RENDER_COLOR, {
+        info[0].As<Napi::Number>().FloatValue(),
+        info[1].As<Napi::Number>().FloatValue(),
+        info[2].As<Napi::Number>().FloatValue(),
+        info[3].IsNumber() ? info[3].As<Napi::Number>().FloatValue() : 1.0f}, "");
+    // clang-format on
+
+    return;
+}
+
+void RenderClientWrapper::Fill(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    this->Send(env, RENDER_FILL, {}, "");
+
+    return;
+}
+
+void RenderClientWrapper::Rect(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+    bool filled = info[4].IsBoolean() ? info[4].As<Napi::Boolean>().Value() : true;
+    float lineWidth = info[5].IsNumber() ? info[5].As<Napi::Number>().FloatValue() : 1;
+
+    if (!info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber() || !info[3].IsNumber()) {
+        Napi::TypeError::New(env, "invalid argument").ThrowAsJavaScriptException();
+        return;
+    }
+
+    // clang-format off
+    this->Send(env, RENDER_RECT, {
+        info[0].As<Napi::Number>().FloatValue(),
+        info[1].As<Napi::Number>().FloatValue(),
+        info[2].As<Napi::Number>().FloatValue(),
+        info[3].As<Napi::Number>().FloatValue(),
+        filled ? 1.0f : 0.0f, lineWidth}, "");
+    // clang-format on
+
+    return;
+}
+
+void RenderClientWrapper::Line(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+    float lineWidth = info[4].IsNumber() ? info[4].As<Napi::Number>().FloatValue() : 1;
+
+    if (!info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber() || !info[3].IsNumber()) {
+        Napi::TypeError::New(env, "invalid argument").ThrowAsJavaScriptException();
+        return;
+    }
+
+    // clang-format off
+    this->Send(env, RENDER_LINE, {
+        info[0].As<Napi::Number>().FloatValue(),
+        info[1].As<Napi::Number>().FloatValue(),
+        info[2].As<Napi::Number>().FloatValue(),
+        info[3].As<Napi::Number>().FloatValue(),
+        lineWidth}, "");
+    // clang-format on
+
+    return;
+}
+
+void RenderClientWrapper::Circle(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+    bool filled = info[3].IsBoolean() ? info[3].As<Napi::Boolean>().Value() : true;
+    float lineWidth = info[4].IsNumber() ? info[4].As<Napi::Number>().FloatValue() : 1;
+
+    if (!info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber()) {
+        Napi::TypeError::New(env, "invalid argument").ThrowAsJavaScriptException();
+        return;
+    }
+
+    // clang-format off
+    this->Send(env, RENDER_CIRCLE, {
+        info[0].As<Napi::Number>().FloatValue(),
+        info[1].As<Napi::Number>().FloatValue(),
+        info[2].As<Napi::Number>().FloatValue(),
+        filled ? 1.0f : 0.0f, lineWidth}, "");
+    // clang-format on
+
+    return;
+}
+
+void RenderClientWrapper::Font(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+    float fontSize = info[1].IsNumber() ? info[1].As<Napi::Number>().FloatValue() : 12;
+    bool bold = info[2].IsBoolean() ? info[2].As<Napi::Boolean>().Value() : false;
+
+    if (!info[0].IsString()) {
+        Napi::TypeError::New(env, "invalid argument").ThrowAsJavaScriptException();
+        return;
+    }
+
+    this->Send(env, RENDER_FONT, {fontSize, bold ? 1.0f : 0.0f}, info[0].As<Napi::String>().Utf8Value());
+
+    return;
+}
+
+void RenderClientWrapper::Text(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+    bool centered = info[3].IsBoolean() ? info[3].As<Napi::Boolean>().Value() : false;
+
+    if (!info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsString()) {
+        Napi::TypeError::New(env, "invalid argument").ThrowAsJavaScriptException();
+        return;
+    }
+
+    // clang-format off
+    this->Send(env, RENDER_TEXT, {
+        info[0].As<Napi::Number>().FloatValue(),
+        info[1].As<Napi::Number>().FloatValue(),
+        centered ? 1.0f : 0.0f}, info[2].As<Napi::String>().Utf8Value());
+    // clang-format on
+
+    return;
+}
+
+void RenderClientWrapper::Pixels(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    if (info.Length() < 5 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber() ||
+        !info[3].IsNumber() || !info[4].IsTypedArray()) {
+        Napi::TypeError::New(env, "expected x, y, width, height and pixel data").ThrowAsJavaScriptException();
+        return;
+    }
+
+    if (this->renderClientClass_ == nullptr) {
+        Napi::Error::New(env, "render client closed").ThrowAsJavaScriptException();
+        return;
+    }
+
+    // format, "rgb565" or "argb32" (cairo's premultiplied native order)
+    RenderPixelFormat format = RENDER_RGB565;
+
+    if (info[5].IsString() && info[5].As<Napi::String>().Utf8Value() == "argb32")
+        format = RENDER_ARGB32;
+
+    uint32_t x = info[0].As<Napi::Number>().Uint32Value();
+    uint32_t y = info[1].As<Napi::Number>().Uint32Value();
+    uint32_t w = info[2].As<Napi::Number>().Uint32Value();
+    uint32_t h = info[3].As<Napi::Number>().Uint32Value();
+    size_t stride = (size_t)w * (format == RENDER_RGB565 ? 2 : 4);
+
+    Napi::TypedArray pixels = info[4].As<Napi::TypedArray>();
+
+    if (pixels.ByteLength() < stride * h) {
+        Napi::RangeError::New(env, "pixel data too short").ThrowAsJavaScriptException();
+        return;
+    }
+
+    const char *data = (const char *)pixels.ArrayBuffer().Data() + pixels.ByteOffset();
+
+    try {
+        this->renderClientClass_->Pixels(x, y, w, h, format, data, stride);
+    } catch (const std::exception &e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+
+    return;
+}
+
+void RenderClientWrapper::Z(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    if (!info[0].IsNumber()) {
+        Napi::TypeError::New(env, "invalid argument").ThrowAsJavaScriptException();
+        return;
+    }
+
+    this->Send(env, RENDER_Z, {info[0].As<Napi::Number>().FloatValue()}, "");
+
+    return;
+}
+
+void RenderClientWrapper::Commit(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    if (this->renderClientClass_ == nullptr) {
+        Napi::Error::New(env, "render client closed").ThrowAsJavaScriptException();
+        return;
+    }
+
+    try {
+        this->renderClientClass_->Commit();
+    } catch (const std::exception &e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+
+    return;
+}
+
+void RenderClientWrapper::Close(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    delete this->renderClientClass_;
+    this->renderClientClass_ = nullptr;
+
+    return;
+}
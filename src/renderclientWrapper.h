@@ -0,0 +1,36 @@
+#ifndef RENDERCLIENTWRAPPER_H
+#define RENDERCLIENTWRAPPER_H
+
+#include "renderserver.h"
+#include <napi.h>
+
+class RenderClientWrapper : public Napi::ObjectWrap<RenderClientWrapper> {
+  public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    RenderClientWrapper(const Napi::CallbackInfo &info);
+    ~RenderClientWrapper();
+
+  private:
+    static Napi::FunctionReference constructor;
+
+    void Clear(const Napi::CallbackInfo &info);
+    void Color(const Napi::CallbackInfo &info);
+    void Fill(const Napi::CallbackInfo &info);
+    void Rect(const Napi::CallbackInfo &info);
+    void Line(const Napi::CallbackInfo &info);
+    void Circle(const Napi::CallbackInfo &info);
+    void Font(const Napi::CallbackInfo &info);
+    void Text(const Napi::CallbackInfo &info);
+    void Pixels(const Napi::CallbackInfo &info);
+    void Z(const Napi::CallbackInfo &info);
+    void Commit(const Napi::CallbackInfo &info);
+    void Close(const Napi::CallbackInfo &info);
+
+    Napi::Value Size(const Napi::CallbackInfo &info);
+
+    void Send(Napi::Env env, RenderOp op, std::vector<float> args, const std::string &data);
+
+    RenderClient *renderClientClass_;
+};
+
+#endif
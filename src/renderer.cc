@@ -0,0 +1,294 @@
+#include "renderer.h"
+
+#include <string.h>
+
+std::mutex Renderer::cacheLock;
+std::condition_variable Renderer::loadedCond;
+std::map<std::string, cairo_font_face_t *> Renderer::fonts;
+std::map<std::string, CachedImage> Renderer::images;
+size_t Renderer::imageBytes = 0;
+unsigned long Renderer::imageClock = 0;
+std::set<std::string> Renderer::loading;
+std::vector<cairo_scaled_font_t *> Renderer::warmFonts;
+
+std::string Renderer::FontKey(const std::string &name, bool bold) { return (bold ? "font:b:" : "font:n:") + name; }
+
+cairo_font_face_t *Renderer::FontFace(const std::string &name, bool bold) {
+    std::unique_lock<std::mutex> lock(cacheLock);
+    std::string key = FontKey(name, bold);
+
+    // a face being warmed is waited for, the first text would otherwise pay for fontconfig again
+    loadedCond.wait(lock, [&key]() { return loading.count(key) == 0; });
+
+    auto it = fonts.find(key);
+    if (it != fonts.end())
+        return cairo_font_face_reference(it->second);
+
+    cairo_font_face_t *face = cairo_toy_font_face_create(name.c_str(), CAIRO_FONT_SLANT_NORMAL,
+                                                         bold ? CAIRO_FONT_WEIGHT_BOLD : CAIRO_FONT_WEIGHT_NORMAL);
+    fonts[key] = face;
+
+    return cairo_font_face_reference(face);
+}
+
+static bool SameFile(const CachedImage &image, const struct stat &file) {
+    return image.mtime.tv_sec == file.st_mtim.tv_sec && image.mtime.tv_nsec == file.st_mtim.tv_nsec &&
+           image.size == file.st_size;
+}
+
+cairo_surface_t *Renderer::CachedImageFor(const std::string &path, const struct stat &file) {
+    auto it = images.find(path);
+    if (it == images.end())
+        return nullptr;
+
+    if (!SameFile(it->second, file)) {
+        DropImage(it);
+        return nullptr;
+    }
+
+    it->second.lastUse = ++imageClock;
+
+    return cairo_surface_reference(it->second.surface);
+}
+
+cairo_surface_t *Renderer::StoreImage(const std::string &path, const struct stat &file, cairo_surface_t *image) {
+    auto it = images.find(path);
+
+    // a preload or another panel may have stored the same file meanwhile
+    if (it != images.end()) {
+        if (SameFile(it->second, file)) {
+            cairo_surface_destroy(image);
+            it->second.lastUse = ++imageClock;
+            return cairo_surface_reference(it->second.surface);
+        }
+
+        DropImage(it);
+    }
+
+    CachedImage cached;
+    cached.surface = image;
+    cached.mtime = file.st_mtim;
+    cached.size = file.st_size;
+    cached.bytes = (size_t)cairo_image_surface_get_stride(image) * cairo_image_surface_get_height(image);
+    cached.lastUse = ++imageClock;
+
+    images[path] = cached;
+    imageBytes += cached.bytes;
+
+    // evict the least recently used images, the one just stored stays even when it is bigger than the cap
+    while (imageBytes > IMAGE_CACHE_BYTES && images.size() > 1) {
+        auto oldest = images.end();
+
+        for (auto candidate = images.begin(); candidate != images.end(); candidate++) {
+            if (candidate->first == path)
+                continue;
+            if (oldest == images.end() || candidate->second.lastUse < oldest->second.lastUse)
+                oldest = candidate;
+        }
+
+        DropImage(oldest);
+    }
+
+    return cairo_surface_reference(image);
+}
+
+void Renderer::DropImage(std::map<std::string, CachedImage>::iterator it) {
+    // draws holding a reference keep the surface alive
+    cairo_surface_destroy(it->second.surface);
+    imageBytes -= it->second.bytes;
+    images.erase(it);
+
+    return;
+}
+
+cairo_surface_t *Renderer::Image(const std::string &path) {
+    struct stat file;
+
+    // an unreadable file fails the decode below with a proper error
+    if (stat(path.c_str(), &file) != 0)
+        memset(&file, 0, sizeof(file));
+
+    {
+        std::unique_lock<std::mutex> lock(cacheLock);
+
+        // whoever is decoding this image already, a preload or another panel, finishes it for us
+        loadedCond.wait(lock, [&path]() { return loading.count(path) == 0; });
+
+        cairo_surface_t *cached = CachedImageFor(path, file);
+        if (cached != nullptr)
+            return cached;
+
+        loading.insert(path);
+    }
+
+    // decode outside the lock so panels loading different images do not wait on each other
+    cairo_surface_t *image = cairo_image_surface_create_from_png(path.c_str());
+    cairo_status_t status = cairo_surface_status(image);
+
+    if (status != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(image);
+        Release(path);
+        throw std::runtime_error("Error reading image: " + path + " : " + cairo_status_to_string(status));
+    }
+
+    std::lock_guard<std::mutex> lock(cacheLock);
+
+    image = StoreImage(path, file, image);
+    loading.erase(path);
+    loadedCond.notify_all();
+
+    return image;
+}
+
+void Renderer::Reserve(const PreloadManifest &manifest) {
+    std::lock_guard<std::mutex> lock(cacheLock);
+
+    for (size_t i = 0; i < manifest.fonts.size(); i++)
+        loading.insert(FontKey(manifest.fonts[i].name, manifest.fonts[i].bold));
+
+    for (size_t i = 0; i < manifest.images.size(); i++)
+        if (images.find(manifest.images[i]) == images.end())
+            loading.insert(manifest.images[i]);
+
+    return;
+}
+
+std::string Renderer::Preload(const PreloadManifest &manifest) {
+    std::string error;
+
+    for (size_t i = 0; i < manifest.fonts.size(); i++) {
+        const PreloadFont &font = manifest.fonts[i];
+        std::string key = FontKey(font.name, font.bold);
+        cairo_font_face_t *face = nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(cacheLock);
+            auto it = fonts.find(key);
+            if (it != fonts.end())
+                face = cairo_font_face_reference(it->second);
+        }
+
+        if (face == nullptr)
+            face = cairo_toy_font_face_create(font.name.c_str(), CAIRO_FONT_SLANT_NORMAL,
+                                              font.bold ? CAIRO_FONT_WEIGHT_BOLD : CAIRO_FONT_WEIGHT_NORMAL);
+
+        // resolving the face runs fontconfig, measuring the printable ASCII range fills the glyph cache
+        cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_RGB16_565, 1, 1);
+        cairo_t *cr = cairo_create(surface);
+        std::vector<cairo_scaled_font_t *> scaled;
+
+        cairo_set_font_face(cr, face);
+
+        for (size_t s = 0; s < font.sizes.size(); s++) {
+            cairo_text_extents_t extents;
+
+            cairo_set_font_size(cr, font.sizes[s]);
+            cairo_text_extents(cr, " !\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`"
+                                   "abcdefghijklmnopqrstuvwxyz{|}~",
+                               &extents);
+            scaled.push_back(cairo_scaled_font_reference(cairo_get_scaled_font(cr)));
+        }
+
+        if (cairo_status(cr) != CAIRO_STATUS_SUCCESS && error.empty())
+            error = "Error preloading font: " + font.name + " : " + cairo_status_to_string(cairo_status(cr));
+
+        cairo_destroy(cr);
+        cairo_surface_destroy(surface);
+
+        std::lock_guard<std::mutex> lock(cacheLock);
+
+        if (fonts.find(key) == fonts.end())
+            fonts[key] = cairo_font_face_reference(face);
+
+        cairo_font_face_destroy(face);
+        warmFonts.insert(warmFonts.end(), scaled.begin(), scaled.end());
+        loading.erase(key);
+        loadedCond.notify_all();
+    }
+
+    for (size_t i = 0; i < manifest.images.size(); i++) {
+        const std::string &path = manifest.images[i];
+        struct stat file;
+
+        if (stat(path.c_str(), &file) != 0)
+            memset(&file, 0, sizeof(file));
+
+        {
+            std::lock_guard<std::mutex> lock(cacheLock);
+            cairo_surface_t *cached = CachedImageFor(path, file);
+
+            if (cached != nullptr) {
+                cairo_surface_destroy(cached);
+                continue;
+            }
+        }
+
+        cairo_surface_t *image = cairo_image_surface_create_from_png(path.c_str());
+        cairo_status_t status = cairo_surface_status(image);
+
+        if (status != CAIRO_STATUS_SUCCESS) {
+            cairo_surface_destroy(image);
+            Release(path);
+
+            if (error.empty())
+                error = "Error reading image: " + path + " : " + cairo_status_to_string(status);
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(cacheLock);
+
+        // two panels may preload the same image
+        cairo_surface_destroy(StoreImage(path, file, image));
+        loading.erase(path);
+        loadedCond.notify_all();
+    }
+
+    return error;
+}
+
+void Renderer::Release(const std::string &key) {
+    std::lock_guard<std::mutex> lock(cacheLock);
+
+    loading.erase(key);
+    loadedCond.notify_all();
+
+    return;
+}
+
+size_t Renderer::ImageCacheSize() {
+    std::lock_guard<std::mutex> lock(cacheLock);
+
+    return imageBytes;
+}
+
+void Renderer::ClearCaches() {
+    std::lock_guard<std::mutex> lock(cacheLock);
+
+    for (auto it = images.begin(); it != images.end(); it++)
+        cairo_surface_destroy(it->second.surface);
+    images.clear();
+    imageBytes = 0;
+
+    for (size_t i = 0; i < warmFonts.size(); i++)
+        cairo_scaled_font_destroy(warmFonts[i]);
+    warmFonts.clear();
+
+    for (auto it = fonts.begin(); it != fonts.end(); it++)
+        cairo_font_face_destroy(it->second);
+    fonts.clear();
+
+    return;
+}
+
+SyncGroup::SyncGroup(int count) { remaining = count; }
+
+void SyncGroup::ArriveAndWait() {
+    std::unique_lock<std::mutex> guard(this->lock);
+
+    if (--this->remaining <= 0)
+        this->cond.notify_all();
+    else
+        this->cond.wait(guard, [this]() { return this->remaining <= 0; });
+
+    return;
+}
@@ -0,0 +1,97 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <cairo/cairo.h>
+#include <sys/stat.h>
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// decoded images above this many bytes are evicted, least recently used first
+#define IMAGE_CACHE_BYTES (8 << 20)
+
+struct PreloadFont {
+    std::string name;
+    bool bold;
+    std::vector<double> sizes;
+};
+
+// Fonts and images to warm on a background thread right after startup, image paths are absolute.
+struct PreloadManifest {
+    std::vector<PreloadFont> fonts;
+    std::vector<std::string> images;
+};
+
+// A decoded image and the file it came from, a changed modification time or size reloads it.
+struct CachedImage {
+    cairo_surface_t *surface;
+    struct timespec mtime;
+    off_t size;
+    size_t bytes;
+    unsigned long lastUse;
+};
+
+// Process-wide caches shared by every FrameBuffer, whichever thread renders it. Font faces are shared, so cairo's
+// per-face scaled font and glyph caches are shared as well.
+class Renderer {
+  public:
+    // Returns a new reference to the shared face.
+    static cairo_font_face_t *FontFace(const std::string &name, bool bold);
+    // Returns a new reference to the decoded image, throws when it cannot be read. Images changed on disk since
+    // they were cached are decoded again.
+    static cairo_surface_t *Image(const std::string &path);
+    static void ClearCaches();
+    // Bytes of decoded pixels held by the image cache.
+    static size_t ImageCacheSize();
+
+    // Marks everything in the manifest as loading, draws that need one of them wait for Preload() instead of
+    // loading it themselves.
+    static void Reserve(const PreloadManifest &manifest);
+    // Loads a reserved manifest, returns the first error or an empty string.
+    static std::string Preload(const PreloadManifest &manifest);
+
+  private:
+    static std::string FontKey(const std::string &name, bool bold);
+    static void Release(const std::string &key);
+    // called with cacheLock held
+    static cairo_surface_t *CachedImageFor(const std::string &path, const struct stat &file);
+    static cairo_surface_t *StoreImage(const std::string &path, const struct stat &file, cairo_surface_t *image);
+    static void DropImage(std::map<std::string, CachedImage>::iterator it);
+
+    static std::mutex cacheLock;
+    static std::condition_variable loadedCond;
+    static std::map<std::string, cairo_font_face_t *> fonts;
+    static std::map<std::string, CachedImage> images;
+    static size_t imageBytes;
+    static unsigned long imageClock;
+    // keys of fonts and images being loaded by some thread
+    static std::set<std::string> loading;
+    // scaled fonts created by preloads, held so cairo keeps their glyph caches
+    static std::vector<cairo_scaled_font_t *> warmFonts;
+};
+
+// Something painted over the back buffer every time a FrameBuffer presents, under its render lock.
+class Overlay {
+  public:
+    virtual ~Overlay() {}
+    virtual void Paint(cairo_t *cr) = 0;
+};
+
+// Lets the render threads of several panels rasterize independently and present together.
+class SyncGroup {
+  public:
+    SyncGroup(int count);
+    void ArriveAndWait();
+
+  private:
+    std::mutex lock;
+    std::condition_variable cond;
+    int remaining;
+};
+
+#endif
@@ -0,0 +1,731 @@
+#include "renderserver.h"
+
+#include <errno.h>
+#include <math.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include <algorithm>
+
+static double Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// Copies out of / into the ring, wrapping at the end. Offsets are free running and taken modulo the size, each side
+// uses the size it agreed on rather than the one in shared memory.
+static void RingRead(RenderRing *ring, size_t size, uint32_t offset, void *out, size_t length) {
+    size_t start = offset & (size - 1);
+    size_t first = std::min(length, size - start);
+
+    memcpy(out, ring->data + start, first);
+    memcpy((char *)out + first, ring->data, length - first);
+
+    return;
+}
+
+static void RingWrite(RenderRing *ring, size_t size, uint32_t offset, const void *in, size_t length) {
+    size_t start = offset & (size - 1);
+    size_t first = std::min(length, size - start);
+
+    memcpy(ring->data + start, in, first);
+    memcpy(ring->data, (const char *)in + first, length - first);
+
+    return;
+}
+
+RenderServer::RenderServer(FrameBuffer *fb, std::string socketPath, double fps) {
+    frameBuffer = fb;
+    path = socketPath;
+    frameInterval = fps > 0 ? 1000.0 / fps : 0;
+    nextOrder = 0;
+    dirty = false;
+    running = true;
+
+    if (!frameBuffer->DoubleBuffered())
+        throw std::runtime_error("Error starting render server, the server needs double buffering");
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if (path.size() >= sizeof(addr.sun_path))
+        throw std::runtime_error("Error starting render server, socket path too long");
+
+    strcpy(addr.sun_path, path.c_str());
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd == -1)
+        throw std::runtime_error("Error starting render server, cannot create socket");
+
+    // a socket left behind by a server that died would make bind fail, but anything else at the path, a live
+    // server's socket included, is not ours to remove
+    struct stat st;
+
+    if (lstat(path.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            close(listenFd);
+            throw std::runtime_error("Error starting render server, " + path + " exists and is not a socket");
+        }
+
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int connected = probe == -1 ? -1 : connect(probe, (struct sockaddr *)&addr, sizeof(addr));
+        int error = errno;
+
+        if (probe != -1)
+            close(probe);
+
+        if (connected == 0 || probe == -1 || (error != ECONNREFUSED && error != ENOENT)) {
+            close(listenFd);
+            throw std::runtime_error("Error starting render server, " + path + " is in use");
+        }
+
+        unlink(path.c_str());
+    }
+
+    if (bind(listenFd, (struct sockaddr *)&addr, sizeof(addr)) == -1 || listen(listenFd, 16) == -1) {
+        close(listenFd);
+        throw std::runtime_error("Error starting render server, cannot listen on " + path);
+    }
+
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+
+    if (wakeFd == -1 || epfd == -1) {
+        close(listenFd);
+        if (wakeFd != -1)
+            close(wakeFd);
+        if (epfd != -1)
+            close(epfd);
+        unlink(path.c_str());
+        throw std::runtime_error("Error starting render server");
+    }
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, listenFd, &ev);
+    ev.data.ptr = this;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, wakeFd, &ev);
+
+    try {
+        frameBuffer->AddOverlay(this);
+    } catch (const std::exception &e) {
+        close(listenFd);
+        close(wakeFd);
+        close(epfd);
+        unlink(path.c_str());
+        throw;
+    }
+
+    thread = std::thread(&RenderServer::Run, this);
+
+    return;
+}
+
+void RenderServer::Close() {
+    if (!this->thread.joinable())
+        return;
+
+    uint64_t one = 1;
+    this->running = false;
+
+    if (write(this->wakeFd, &one, sizeof(one)) == -1) {
+        // the eventfd only fails when its counter overflows, the thread is awake anyway
+    }
+
+    this->thread.join();
+
+    // drop our surfaces from the screen on the next present
+    this->frameBuffer->RemoveOverlay(this);
+
+    for (size_t i = 0; i < this->clients.size(); i++) {
+        RenderServerClient *client = this->clients[i];
+
+        close(client->sock);
+        munmap(client->ring, client->mapSize);
+        cairo_surface_destroy(client->back);
+        cairo_surface_destroy(client->front);
+        delete client;
+    }
+
+    this->clients.clear();
+
+    close(this->listenFd);
+    close(this->wakeFd);
+    close(this->epfd);
+    unlink(this->path.c_str());
+
+    return;
+}
+
+size_t RenderServer::Clients() {
+    std::lock_guard<std::mutex> lock(this->clientsLock);
+
+    return this->clients.size();
+}
+
+void RenderServer::Run() {
+    struct epoll_event events[16];
+    double lastPresent = 0;
+
+    while (this->running) {
+        int timeout = -1;
+
+        // frames are coalesced, at most one present per frame interval however often clients commit
+        if (this->dirty) {
+            double wait = lastPresent + this->frameInterval - Now();
+            timeout = wait > 0 ? (int)ceil(wait) : 0;
+        }
+
+        int n = epoll_wait(this->epfd, events, 16, timeout);
+
+        if (n == -1 && errno != EINTR)
+            break;
+
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.ptr == nullptr) {
+                this->Accept();
+                continue;
+            }
+
+            if (events[i].data.ptr == this)
+                continue;
+
+            RenderServerClient *client = (RenderServerClient *)events[i].data.ptr;
+            bool hungUp = (events[i].events & (EPOLLHUP | EPOLLERR)) != 0;
+            char buffer[256];
+
+            // the bytes are only a doorbell, the commands are in the ring
+            while (true) {
+                ssize_t got = read(client->sock, buffer, sizeof(buffer));
+
+                if (got > 0)
+                    continue;
+                if (got == 0 || (errno != EAGAIN && errno != EINTR))
+                    hungUp = true;
+                if (got == 0 || errno != EINTR)
+                    break;
+            }
+
+            // whatever the client committed before going away is still drawn
+            if (!this->Drain(client) || hungUp)
+                this->Remove(client);
+        }
+
+        if (this->dirty && Now() >= lastPresent + this->frameInterval) {
+            this->dirty = false;
+            lastPresent = Now();
+            this->frameBuffer->PresentFrame();
+        }
+    }
+
+    return;
+}
+
+void RenderServer::Accept() {
+    while (true) {
+        int sock = accept4(this->listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (sock == -1)
+            return;
+
+        size_t mapSize = sizeof(RenderRing) + RENDER_RING_SIZE;
+        int memfd = memfd_create("pitft-render", MFD_CLOEXEC);
+
+        if (memfd == -1 || ftruncate(memfd, mapSize) == -1) {
+            if (memfd != -1)
+                close(memfd);
+            close(sock);
+            continue;
+        }
+
+        RenderRing *ring = (RenderRing *)mmap(0, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+
+        if (ring == MAP_FAILED) {
+            close(memfd);
+            close(sock);
+            continue;
+        }
+
+        ring->magic = RENDER_MAGIC;
+        ring->version = RENDER_VERSION;
+        ring->size = RENDER_RING_SIZE;
+        ring->head = 0;
+        ring->tail = 0;
+
+        RenderHello hello;
+        hello.magic = RENDER_MAGIC;
+        hello.version = RENDER_VERSION;
+        hello.width = this->frameBuffer->vinfo.xres;
+        hello.height = this->frameBuffer->vinfo.yres;
+        hello.size = RENDER_RING_SIZE;
+
+        // the ring goes to the client as a file descriptor next to the hello
+        struct iovec iov;
+        iov.iov_base = &hello;
+        iov.iov_len = sizeof(hello);
+
+        char control[CMSG_SPACE(sizeof(int))];
+        memset(control, 0, sizeof(control));
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &memfd, sizeof(int));
+
+        ssize_t sent = sendmsg(sock, &msg, MSG_NOSIGNAL);
+        close(memfd);
+
+        if (sent != sizeof(hello)) {
+            munmap(ring, mapSize);
+            close(sock);
+            continue;
+        }
+
+        RenderServerClient *client = new RenderServerClient();
+        client->sock = sock;
+        client->ring = ring;
+        client->mapSize = mapSize;
+        client->order = this->nextOrder++;
+        client->back = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, hello.width, hello.height);
+        client->front = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, hello.width, hello.height);
+        client->r = client->g = client->b = client->a = 1;
+        client->fontName = "Sans";
+        client->fontSize = 12;
+        client->fontBold = false;
+        client->z = 0;
+
+        {
+            std::lock_guard<std::mutex> lock(this->clientsLock);
+            this->clients.push_back(client);
+        }
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.ptr = client;
+        epoll_ctl(this->epfd, EPOLL_CTL_ADD, sock, &ev);
+    }
+}
+
+void RenderServer::Remove(RenderServerClient *client) {
+    epoll_ctl(this->epfd, EPOLL_CTL_DEL, client->sock, nullptr);
+
+    {
+        std::lock_guard<std::mutex> lock(this->clientsLock);
+        this->clients.erase(std::find(this->clients.begin(), this->clients.end(), client));
+    }
+
+    close(client->sock);
+    munmap(client->ring, client->mapSize);
+    cairo_surface_destroy(client->back);
+    cairo_surface_destroy(client->front);
+    delete client;
+
+    this->dirty = true;
+
+    return;
+}
+
+bool RenderServer::Drain(RenderServerClient *client) {
+    RenderRing *ring = client->ring;
+    uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+    uint32_t head = ring->head.load(std::memory_order_acquire);
+
+    while (tail != head) {
+        RenderCommand command;
+
+        if (head - tail < sizeof(command) || head - tail > RENDER_RING_SIZE)
+            return false;
+
+        RingRead(ring, RENDER_RING_SIZE, tail, &command, sizeof(command));
+
+        // a malformed ring means a broken client, it is dropped
+        if (command.length < sizeof(command) || command.length % 4 != 0 || command.length > head - tail)
+            return false;
+
+        size_t payload = command.length - sizeof(command);
+        client->scratch.resize(payload);
+        if (payload > 0)
+            RingRead(ring, RENDER_RING_SIZE, tail + sizeof(command), client->scratch.data(), payload);
+
+        this->Execute(client, command.op, (const float *)client->scratch.data(), payload / sizeof(float),
+                      client->scratch.data(), payload);
+
+        tail += command.length;
+        // hand the space back as soon as the command is copied out
+        ring->tail.store(tail, std::memory_order_release);
+        head = ring->head.load(std::memory_order_acquire);
+    }
+
+    return true;
+}
+
+void RenderServer::Execute(RenderServerClient *client, uint16_t op, const float *args, size_t count,
+                           const char *data, size_t length) {
+    cairo_t *cr;
+
+    switch (op) {
+    case RENDER_CLEAR:
+        cr = cairo_create(client->back);
+        cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+        cairo_paint(cr);
+        cairo_destroy(cr);
+        break;
+    case RENDER_COLOR:
+        if (count < 4)
+            break;
+        client->r = args[0];
+        client->g = args[1];
+        client->b = args[2];
+        client->a = args[3];
+        break;
+    case RENDER_FILL:
+        cr = cairo_create(client->back);
+        cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+        cairo_set_source_rgba(cr, client->r, client->g, client->b, client->a);
+        cairo_paint(cr);
+        cairo_destroy(cr);
+        break;
+    case RENDER_RECT:
+        if (count < 6)
+            break;
+        cr = cairo_create(client->back);
+        cairo_set_source_rgba(cr, client->r, client->g, client->b, client->a);
+        cairo_rectangle(cr, args[0], args[1], args[2], args[3]);
+        if (args[4] != 0)
+            cairo_fill(cr);
+        else {
+            cairo_set_line_width(cr, args[5]);
+            cairo_stroke(cr);
+        }
+        cairo_destroy(cr);
+        break;
+    case RENDER_LINE:
+        if (count < 5)
+            break;
+        cr = cairo_create(client->back);
+        cairo_set_source_rgba(cr, client->r, client->g, client->b, client->a);
+        cairo_move_to(cr, args[0], args[1]);
+        cairo_line_to(cr, args[2], args[3]);
+        cairo_set_line_width(cr, args[4]);
+        cairo_stroke(cr);
+        cairo_destroy(cr);
+        break;
+    case RENDER_CIRCLE:
+        if (count < 5)
+            break;
+        cr = cairo_create(client->back);
+        cairo_set_source_rgba(cr, client->r, client->g, client->b, client->a);
+        cairo_arc(cr, args[0], args[1], args[2], 0, 2 * 3.141592654);
+        if (args[3] != 0)
+            cairo_fill(cr);
+        else {
+            cairo_set_line_width(cr, args[4]);
+            cairo_stroke(cr);
+        }
+        cairo_destroy(cr);
+        break;
+    case RENDER_FONT:
+        if (count < 2)
+            break;
+        client->fontSize = args[0];
+        client->fontBold = args[1] != 0;
+        client->fontName = std::string(data + 2 * sizeof(float), strnlen(data + 2 * sizeof(float), length - 8));
+        break;
+    case RENDER_TEXT: {
+        if (count < 3)
+            break;
+        std::string text(data + 3 * sizeof(float), strnlen(data + 3 * sizeof(float), length - 12));
+        cairo_font_face_t *face = Renderer::FontFace(client->fontName, client->fontBold);
+
+        cr = cairo_create(client->back);
+        cairo_set_source_rgba(cr, client->r, client->g, client->b, client->a);
+        cairo_set_font_face(cr, face);
+        cairo_set_font_size(cr, client->fontSize);
+        cairo_move_to(cr, args[0], args[1]);
+
+        if (args[2] != 0) {
+            cairo_text_extents_t extents;
+            cairo_text_extents(cr, text.c_str(), &extents);
+            cairo_rel_move_to(cr, -extents.width / 2, extents.height / 2);
+        }
+
+        cairo_show_text(cr, text.c_str());
+        cairo_destroy(cr);
+        cairo_font_face_destroy(face);
+        break;
+    }
+    case RENDER_PIXELS: {
+        if (length < 5 * sizeof(uint32_t))
+            break;
+
+        const uint32_t *header = (const uint32_t *)data;
+        uint32_t x = header[0], y = header[1], w = header[2], h = header[3];
+        size_t bpp = header[4] == RENDER_RGB565 ? 2 : 4;
+        const char *pixels = data + 5 * sizeof(uint32_t);
+
+        if ((size_t)w * h * bpp > length - 5 * sizeof(uint32_t))
+            break;
+
+        int width = cairo_image_surface_get_width(client->back);
+        int height = cairo_image_surface_get_height(client->back);
+        int stride = cairo_image_surface_get_stride(client->back);
+
+        cairo_surface_flush(client->back);
+        unsigned char *target = cairo_image_surface_get_data(client->back);
+
+        // pixel regions skip cairo, rows are copied (and widened from RGB565) straight into the surface
+        for (uint32_t row = 0; row < h && y + row < (uint32_t)height; row++) {
+            uint32_t *out = (uint32_t *)(target + (size_t)(y + row) * stride) + x;
+            const char *in = pixels + (size_t)row * w * bpp;
+            uint32_t columns = x < (uint32_t)width ? std::min(w, width - x) : 0;
+
+            if (bpp == 4) {
+                memcpy(out, in, columns * 4);
+                continue;
+            }
+
+            for (uint32_t col = 0; col < columns; col++) {
+                uint16_t p = ((const uint16_t *)in)[col];
+                uint32_t r = (p >> 11) & 0x1f, g = (p >> 5) & 0x3f, b = p & 0x1f;
+
+                out[col] = 0xff000000 | ((r << 3 | r >> 2) << 16) | ((g << 2 | g >> 4) << 8) | (b << 3 | b >> 2);
+            }
+        }
+
+        cairo_surface_mark_dirty(client->back);
+        break;
+    }
+    case RENDER_Z:
+        if (count < 1)
+            break;
+        client->z = (int)args[0];
+        break;
+    case RENDER_COMMIT: {
+        cairo_surface_flush(client->back);
+
+        std::lock_guard<std::mutex> lock(this->clientsLock);
+        cairo_surface_flush(client->front);
+        memcpy(cairo_image_surface_get_data(client->front), cairo_image_surface_get_data(client->back),
+               (size_t)cairo_image_surface_get_stride(client->back) * cairo_image_surface_get_height(client->back));
+        cairo_surface_mark_dirty(client->front);
+        this->dirty = true;
+        break;
+    }
+    }
+
+    return;
+}
+
+void RenderServer::Paint(cairo_t *cr) {
+    std::lock_guard<std::mutex> lock(this->clientsLock);
+    std::vector<RenderServerClient *> sorted = this->clients;
+
+    // lower z first, clients with the same z stack in connection order
+    std::sort(sorted.begin(), sorted.end(), [](RenderServerClient *a, RenderServerClient *b) {
+        return a->z != b->z ? a->z < b->z : a->order < b->order;
+    });
+
+    for (size_t i = 0; i < sorted.size(); i++) {
+        cairo_set_source_surface(cr, sorted[i]->front, 0, 0);
+        cairo_paint(cr);
+    }
+
+    return;
+}
+
+RenderServer::~RenderServer() { this->Close(); }
+
+RenderClient::RenderClient(std::string path) {
+    ring = nullptr;
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if (path.size() >= sizeof(addr.sun_path))
+        throw std::runtime_error("Error connecting to render server, socket path too long");
+
+    strcpy(addr.sun_path, path.c_str());
+
+    sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock == -1)
+        throw std::runtime_error("Error connecting to render server, cannot create socket");
+
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        close(sock);
+        throw std::runtime_error("Error connecting to render server at " + path);
+    }
+
+    RenderHello hello;
+    struct iovec iov;
+    iov.iov_base = &hello;
+    iov.iov_len = sizeof(hello);
+
+    char control[CMSG_SPACE(sizeof(int))];
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t got = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    int memfd = -1;
+
+    if (cmsg != nullptr && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+        memcpy(&memfd, CMSG_DATA(cmsg), sizeof(int));
+
+    if (got != sizeof(hello) || memfd == -1 || hello.magic != RENDER_MAGIC || hello.version != RENDER_VERSION) {
+        if (memfd != -1)
+            close(memfd);
+        close(sock);
+        throw std::runtime_error("Error connecting to render server, bad handshake");
+    }
+
+    if (hello.size == 0 || (hello.size & (hello.size - 1)) != 0) {
+        close(memfd);
+        close(sock);
+        throw std::runtime_error("Error connecting to render server, bad ring size");
+    }
+
+    width = hello.width;
+    height = hello.height;
+    size = hello.size;
+    mapSize = sizeof(RenderRing) + size;
+    ring = (RenderRing *)mmap(0, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    close(memfd);
+
+    if (ring == MAP_FAILED) {
+        ring = nullptr;
+        close(sock);
+        throw std::runtime_error("Error connecting to render server, cannot map ring");
+    }
+
+    // wake ups are best effort, a full socket buffer already means the server has work queued
+    int flags = fcntl(sock, F_GETFL);
+    fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+
+    return;
+}
+
+void RenderClient::Write(uint16_t op, const float *args, size_t count, const void *data, size_t length) {
+    if (this->ring == nullptr)
+        throw std::runtime_error("Error drawing, render client closed");
+
+    RenderCommand command;
+    command.op = op;
+    command.reserved = 0;
+    command.length = (sizeof(command) + count * sizeof(float) + length + 3) & ~3u;
+
+    if (command.length > this->size)
+        throw std::runtime_error("Error drawing, command larger than the render ring");
+
+    uint32_t head = this->ring->head.load(std::memory_order_relaxed);
+
+    // the ring is full, wake the server and wait for it to catch up
+    if (this->size - (head - this->ring->tail.load(std::memory_order_acquire)) < command.length) {
+        double deadline = Now() + 2000;
+        this->Wake();
+
+        while (this->size - (head - this->ring->tail.load(std::memory_order_acquire)) < command.length) {
+            struct pollfd pfd;
+            pfd.fd = this->sock;
+            pfd.events = POLLRDHUP;
+
+            if (poll(&pfd, 1, 1) > 0 || Now() > deadline)
+                throw std::runtime_error("Error drawing, render server not responding");
+        }
+    }
+
+    uint32_t offset = head;
+    RingWrite(this->ring, this->size, offset, &command, sizeof(command));
+    offset += sizeof(command);
+
+    if (count > 0) {
+        RingWrite(this->ring, this->size, offset, args, count * sizeof(float));
+        offset += count * sizeof(float);
+    }
+
+    if (length > 0)
+        RingWrite(this->ring, this->size, offset, data, length);
+
+    this->ring->head.store(head + command.length, std::memory_order_release);
+
+    return;
+}
+
+void RenderClient::Pixels(uint32_t x, uint32_t y, uint32_t w, uint32_t h, RenderPixelFormat format,
+                          const char *data, size_t stride) {
+    size_t bpp = format == RENDER_RGB565 ? 2 : 4;
+    size_t rowBytes = w * bpp;
+
+    if (w == 0 || h == 0)
+        return;
+
+    // big regions go in bands of rows so a band never needs more than half the ring
+    size_t rows = this->size / 2 / rowBytes;
+
+    if (rows == 0)
+        throw std::runtime_error("Error drawing pixels, row larger than the render ring");
+
+    std::vector<char> band;
+
+    for (uint32_t row = 0; row < h; row += rows) {
+        uint32_t count = std::min((uint32_t)rows, h - row);
+        uint32_t header[5] = {x, y + row, w, count, (uint32_t)format};
+
+        band.resize(sizeof(header) + count * rowBytes);
+        memcpy(band.data(), header, sizeof(header));
+
+        for (uint32_t i = 0; i < count; i++)
+            memcpy(band.data() + sizeof(header) + i * rowBytes, data + (row + i) * stride, rowBytes);
+
+        this->Write(RENDER_PIXELS, nullptr, 0, band.data(), band.size());
+    }
+
+    return;
+}
+
+void RenderClient::Commit() {
+    this->Write(RENDER_COMMIT, nullptr, 0, nullptr, 0);
+    this->Wake();
+
+    return;
+}
+
+void RenderClient::Wake() {
+    char byte = 0;
+
+    if (send(this->sock, &byte, 1, MSG_DONTWAIT | MSG_NOSIGNAL) == -1) {
+        // EAGAIN means plenty of wake ups are already pending, a closed server shows up on the next wait
+    }
+
+    return;
+}
+
+void RenderClient::Close() {
+    if (this->ring == nullptr)
+        return;
+
+    munmap(this->ring, this->mapSize);
+    close(this->sock);
+    this->ring = nullptr;
+
+    return;
+}
+
+RenderClient::~RenderClient() { this->Close(); }
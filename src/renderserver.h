@@ -0,0 +1,143 @@
+#ifndef RENDERSERVER_H
+#define RENDERSERVER_H
+
+#include "framebuffer.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <atomic>
+
+// Render server protocol. A client connects to the server's Unix socket and receives a hello message together with
+// a shared memory file descriptor. The memory holds a RenderRing header followed by a ring of binary draw commands:
+// the client appends at head, the server consumes at tail. The client writes a byte to the socket when it commits a
+// frame (or waits for space) to wake the server up. Each client draws into its own surface, the server composites
+// all committed surfaces over its back buffer by z order and blits once per frame.
+
+#define RENDER_MAGIC 0x52465450
+#define RENDER_VERSION 1
+#define RENDER_RING_SIZE (1 << 20)
+
+enum RenderOp {
+    RENDER_CLEAR = 1,
+    RENDER_COLOR,
+    RENDER_FILL,
+    RENDER_RECT,
+    RENDER_LINE,
+    RENDER_CIRCLE,
+    RENDER_FONT,
+    RENDER_TEXT,
+    RENDER_PIXELS,
+    RENDER_Z,
+    RENDER_COMMIT
+};
+
+enum RenderPixelFormat { RENDER_RGB565, RENDER_ARGB32 };
+
+struct RenderHello {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t size;
+};
+
+struct RenderRing {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    uint32_t reserved;
+    // head and tail live on their own cache lines, one is written by each side
+    alignas(64) std::atomic<uint32_t> head;
+    alignas(64) std::atomic<uint32_t> tail;
+    alignas(64) char data[];
+};
+
+// Every command starts with this header, length covers header and payload and is a multiple of 4. The payload is
+// a list of floats (uint32 for pixels) followed by string or pixel bytes.
+struct RenderCommand {
+    uint16_t op;
+    uint16_t reserved;
+    uint32_t length;
+};
+
+struct RenderServerClient {
+    int sock;
+    RenderRing *ring;
+    size_t mapSize;
+    size_t order;
+
+    // the client draws into back, a commit copies it to front which is what gets composited
+    cairo_surface_t *back;
+    cairo_surface_t *front;
+
+    double r, g, b, a;
+    std::string fontName;
+    double fontSize;
+    bool fontBold;
+    int z;
+
+    std::vector<char> scratch;
+};
+
+class RenderServer : public Overlay {
+  public:
+    RenderServer(FrameBuffer *frameBuffer, std::string path, double fps);
+    ~RenderServer();
+    void Close();
+    size_t Clients();
+
+    void Paint(cairo_t *cr);
+
+  private:
+    void Run();
+    void Accept();
+    void Remove(RenderServerClient *client);
+    bool Drain(RenderServerClient *client);
+    void Execute(RenderServerClient *client, uint16_t op, const float *args, size_t count, const char *data,
+                 size_t length);
+
+    FrameBuffer *frameBuffer;
+    std::string path;
+    double frameInterval;
+
+    int listenFd;
+    int wakeFd;
+    int epfd;
+
+    std::thread thread;
+    std::atomic<bool> running;
+
+    // guards the client list and the front surfaces, taken inside the framebuffer's render lock
+    std::mutex clientsLock;
+    std::vector<RenderServerClient *> clients;
+    size_t nextOrder;
+    bool dirty;
+};
+
+class RenderClient {
+  public:
+    RenderClient(std::string path);
+    ~RenderClient();
+
+    void Write(uint16_t op, const float *args, size_t count, const void *data, size_t length);
+    void Pixels(uint32_t x, uint32_t y, uint32_t w, uint32_t h, RenderPixelFormat format, const char *data,
+                size_t stride);
+    void Commit();
+    void Close();
+
+    uint32_t width;
+    uint32_t height;
+
+  private:
+    void Wake();
+
+    int sock;
+    RenderRing *ring;
+    uint32_t size;
+    size_t mapSize;
+};
+
+#endif
@@ -0,0 +1,421 @@
+#include "touchscreen.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <time.h>
+
+// EVIOCGABS succeeds with an all zero range for axes the device does not have, so only supported axes with a real
+// range count, the single touch axis first and the multitouch one otherwise
+static bool AxisRange(int fd, const unsigned char *absBits, int axis, int mtAxis, struct input_absinfo &absinfo) {
+    int axes[2] = {axis, mtAxis};
+
+    for (int i = 0; i < 2; i++) {
+        if (!(absBits[axes[i] / 8] & (1 << (axes[i] % 8))))
+            continue;
+
+        if (ioctl(fd, EVIOCGABS(axes[i]), &absinfo) == 0 && absinfo.maximum > absinfo.minimum)
+            return true;
+    }
+
+    return false;
+}
+
+TouchScreen::TouchScreen(const char *path, TouchCalibration calibration, double debounce, int threshold,
+                         bool onlyRegions, std::function<void(const TouchEvent &)> eventCallback,
+                         std::function<void()> endCallback) {
+    cal = calibration;
+    debounceMs = debounce;
+    moveThreshold = threshold < 1 ? 1 : threshold;
+    regionsOnly = onlyRegions;
+    onEvent = eventCallback;
+    onEnd = endCallback;
+
+    rawX = rawY = 0;
+    slot = 0;
+    contact = false;
+    pressed = false;
+    releasePending = false;
+    releaseTime = 0;
+    lastX = lastY = 0;
+    pressRegion = -1;
+    wakeFd = -1;
+    epfd = -1;
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        throw std::runtime_error("Error opening touchscreen device");
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        throw std::runtime_error("Error retrieving data from touchscreen");
+    }
+
+    replay = S_ISREG(st.st_mode);
+
+    // fill in the raw range from the driver when the caller did not calibrate, files and pipes report no axes
+    struct input_absinfo absinfo;
+    unsigned char absBits[ABS_MAX / 8 + 1];
+
+    memset(absBits, 0, sizeof(absBits));
+    ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(absBits)), absBits);
+
+    if (cal.minX == -1 || cal.maxX == -1) {
+        if (AxisRange(fd, absBits, ABS_X, ABS_MT_POSITION_X, absinfo)) {
+            if (cal.minX == -1)
+                cal.minX = absinfo.minimum;
+            if (cal.maxX == -1)
+                cal.maxX = absinfo.maximum;
+        }
+    }
+
+    if (cal.minY == -1 || cal.maxY == -1) {
+        if (AxisRange(fd, absBits, ABS_Y, ABS_MT_POSITION_Y, absinfo)) {
+            if (cal.minY == -1)
+                cal.minY = absinfo.minimum;
+            if (cal.maxY == -1)
+                cal.maxY = absinfo.maximum;
+        }
+    }
+
+    if (cal.minX == -1 || cal.maxX == -1 || cal.minY == -1 || cal.maxY == -1 || cal.minX == cal.maxX ||
+        cal.minY == cal.maxY) {
+        close(fd);
+        throw std::runtime_error("Error calibrating touchscreen, axis range unknown");
+    }
+
+    if (cal.width <= 0)
+        cal.width = abs(cal.maxX - cal.minX) + 1;
+    if (cal.height <= 0)
+        cal.height = abs(cal.maxY - cal.minY) + 1;
+
+    wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (wakeFd == -1 || epfd == -1) {
+        close(fd);
+        if (wakeFd != -1)
+            close(wakeFd);
+        if (epfd != -1)
+            close(epfd);
+        throw std::runtime_error("Error creating touchscreen poller");
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = wakeFd;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, wakeFd, &ev);
+
+    if (!replay) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        ev.data.fd = fd;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    running = true;
+    thread = std::thread(&TouchScreen::Run, this);
+
+    return;
+}
+
+void TouchScreen::AddRegion(int id, double x, double y, double w, double h) {
+    std::lock_guard<std::mutex> lock(this->regionLock);
+
+    for (size_t i = 0; i < this->regions.size(); i++) {
+        if (this->regions[i].id == id) {
+            this->regions.erase(this->regions.begin() + i);
+            break;
+        }
+    }
+
+    this->regions.push_back({id, x, y, w, h});
+
+    return;
+}
+
+void TouchScreen::RemoveRegion(int id) {
+    std::lock_guard<std::mutex> lock(this->regionLock);
+
+    for (size_t i = 0; i < this->regions.size(); i++) {
+        if (this->regions[i].id == id) {
+            this->regions.erase(this->regions.begin() + i);
+            break;
+        }
+    }
+
+    return;
+}
+
+void TouchScreen::ClearRegions() {
+    std::lock_guard<std::mutex> lock(this->regionLock);
+
+    this->regions.clear();
+
+    return;
+}
+
+void TouchScreen::Close() {
+    this->running = false;
+
+    if (this->wakeFd != -1) {
+        uint64_t one = 1;
+        ssize_t ret = write(this->wakeFd, &one, sizeof(one));
+        (void)ret;
+    }
+
+    if (this->thread.joinable() && this->thread.get_id() != std::this_thread::get_id())
+        this->thread.join();
+
+    return;
+}
+
+void TouchScreen::Run() {
+    char buf[64 * sizeof(struct input_event)];
+    size_t pending = 0;
+
+    while (this->running) {
+        if (!this->replay) {
+            int timeout = -1;
+
+            if (this->releasePending) {
+                double left = this->releaseTime + this->debounceMs - Now();
+                timeout = left > 0 ? (int)left + 1 : 0;
+            }
+
+            struct epoll_event events[2];
+            int n = epoll_wait(this->epfd, events, 2, timeout);
+
+            if (n < 0 && errno != EINTR)
+                break;
+
+            if (n == 0) {
+                // no bounce arrived within the debounce window, the release is real
+                if (this->releasePending)
+                    this->FlushRelease();
+                continue;
+            }
+
+            if (!this->running)
+                break;
+
+            bool readable = false;
+            for (int i = 0; i < n; i++)
+                if (events[i].data.fd == this->fd)
+                    readable = true;
+
+            if (!readable)
+                continue;
+        }
+
+        ssize_t len = read(this->fd, buf + pending, sizeof(buf) - pending);
+
+        if (len == 0)
+            break;
+
+        if (len < 0) {
+            if (errno == EAGAIN || errno == EINTR)
+                continue;
+            break;
+        }
+
+        size_t total = pending + len;
+        size_t count = total / sizeof(struct input_event);
+
+        for (size_t i = 0; i < count; i++) {
+            struct input_event ev;
+            memcpy(&ev, buf + i * sizeof(struct input_event), sizeof(ev));
+            this->Process(ev);
+        }
+
+        // pipes may hand us a partial event, keep it for the next read
+        pending = total - count * sizeof(struct input_event);
+        if (pending > 0)
+            memmove(buf, buf + count * sizeof(struct input_event), pending);
+    }
+
+    if (this->releasePending)
+        this->FlushRelease();
+
+    if (this->onEnd)
+        this->onEnd();
+
+    return;
+}
+
+void TouchScreen::Process(const struct input_event &ev) {
+    double time = ev.input_event_sec * 1000.0 + ev.input_event_usec / 1000.0;
+
+    switch (ev.type) {
+    case EV_ABS:
+        switch (ev.code) {
+        case ABS_X:
+            this->rawX = ev.value;
+            break;
+        case ABS_Y:
+            this->rawY = ev.value;
+            break;
+        case ABS_MT_SLOT:
+            this->slot = ev.value;
+            break;
+        case ABS_MT_POSITION_X:
+            if (this->slot == 0)
+                this->rawX = ev.value;
+            break;
+        case ABS_MT_POSITION_Y:
+            if (this->slot == 0)
+                this->rawY = ev.value;
+            break;
+        case ABS_MT_TRACKING_ID:
+            if (this->slot == 0)
+                this->contact = ev.value != -1;
+            break;
+        }
+        break;
+    case EV_KEY:
+        if (ev.code == BTN_TOUCH)
+            this->contact = ev.value != 0;
+        break;
+    case EV_SYN:
+        if (ev.code == SYN_REPORT)
+            this->Report(time);
+        break;
+    }
+
+    return;
+}
+
+void TouchScreen::Report(double time) {
+    if (this->releasePending && time - this->releaseTime >= this->debounceMs)
+        this->FlushRelease();
+
+    if (this->contact) {
+        int x, y;
+        this->Map(this->rawX, this->rawY, &x, &y);
+
+        // contact came back within the debounce window, treat it as the same touch
+        this->releasePending = false;
+
+        if (!this->pressed) {
+            this->pressed = true;
+            this->pressRegion = this->HitTest(x, y);
+            this->lastX = x;
+            this->lastY = y;
+            this->Emit(TOUCH_DOWN, x, y, time);
+        } else if (abs(x - this->lastX) >= this->moveThreshold || abs(y - this->lastY) >= this->moveThreshold) {
+            this->lastX = x;
+            this->lastY = y;
+            this->Emit(TOUCH_MOVE, x, y, time);
+        }
+    } else if (this->pressed && !this->releasePending) {
+        this->releasePending = true;
+        this->releaseTime = time;
+
+        if (this->debounceMs <= 0)
+            this->FlushRelease();
+    }
+
+    return;
+}
+
+void TouchScreen::FlushRelease() {
+    this->releasePending = false;
+    this->pressed = false;
+    this->Emit(TOUCH_UP, this->lastX, this->lastY, this->releaseTime);
+
+    return;
+}
+
+void TouchScreen::Emit(TouchEventType type, int x, int y, double time) {
+    TouchEvent event;
+
+    event.type = type;
+    event.x = x;
+    event.y = y;
+    event.region = this->HitTest(x, y);
+    event.pressRegion = this->pressRegion;
+    event.time = time;
+
+    if (this->regionsOnly && event.region == -1 && event.pressRegion == -1)
+        return;
+
+    if (this->onEvent)
+        this->onEvent(event);
+
+    return;
+}
+
+void TouchScreen::Map(int rx, int ry, int *x, int *y) {
+    double nx = (double)(rx - this->cal.minX) / (this->cal.maxX - this->cal.minX);
+    double ny = (double)(ry - this->cal.minY) / (this->cal.maxY - this->cal.minY);
+    double t;
+
+    nx = nx < 0 ? 0 : (nx > 1 ? 1 : nx);
+    ny = ny < 0 ? 0 : (ny > 1 ? 1 : ny);
+
+    if (this->cal.swapXY) {
+        t = nx;
+        nx = ny;
+        ny = t;
+    }
+
+    if (this->cal.invertX)
+        nx = 1 - nx;
+    if (this->cal.invertY)
+        ny = 1 - ny;
+
+    // follow the display rotation, clockwise
+    switch (this->cal.rotate) {
+    case 90:
+        t = nx;
+        nx = 1 - ny;
+        ny = t;
+        break;
+    case 180:
+        nx = 1 - nx;
+        ny = 1 - ny;
+        break;
+    case 270:
+        t = nx;
+        nx = ny;
+        ny = 1 - t;
+        break;
+    }
+
+    *x = (int)(nx * (this->cal.width - 1) + 0.5);
+    *y = (int)(ny * (this->cal.height - 1) + 0.5);
+
+    return;
+}
+
+int TouchScreen::HitTest(int x, int y) {
+    std::lock_guard<std::mutex> lock(this->regionLock);
+
+    // last added region is on top
+    for (size_t i = this->regions.size(); i-- > 0;) {
+        const TouchRegion &r = this->regions[i];
+        if (x >= r.x && x < r.x + r.w && y >= r.y && y < r.y + r.h)
+            return r.id;
+    }
+
+    return -1;
+}
+
+double TouchScreen::Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+TouchScreen::~TouchScreen() {
+    this->Close();
+
+    if (fd != -1)
+        close(fd);
+
+    if (wakeFd != -1)
+        close(wakeFd);
+
+    if (epfd != -1)
+        close(epfd);
+}
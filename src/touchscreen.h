@@ -0,0 +1,104 @@
+#ifndef TOUCHSCREEN_H
+#define TOUCHSCREEN_H
+
+#include <fcntl.h>
+#include <linux/input.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum TouchEventType { TOUCH_DOWN, TOUCH_MOVE, TOUCH_UP };
+
+struct TouchEvent {
+    TouchEventType type;
+    int x;
+    int y;
+    // id of the topmost region under the point, -1 if none
+    int region;
+    // region the touch started in, lets JS tell a tap from a drag-off
+    int pressRegion;
+    // event time in milliseconds, taken from the evdev timestamps
+    double time;
+};
+
+struct TouchCalibration {
+    // raw axis range, -1 means ask the device (EVIOCGABS)
+    int minX, maxX, minY, maxY;
+    // display size in pixels after rotation
+    int width, height;
+    // 0, 90, 180 or 270
+    int rotate;
+    bool swapXY;
+    bool invertX;
+    bool invertY;
+};
+
+struct TouchRegion {
+    int id;
+    double x, y, w, h;
+};
+
+class TouchScreen {
+  public:
+    TouchScreen(const char *path, TouchCalibration calibration, double debounceMs, int moveThreshold,
+                bool regionsOnly, std::function<void(const TouchEvent &)> onEvent, std::function<void()> onEnd);
+    ~TouchScreen();
+    void AddRegion(int id, double x, double y, double w, double h);
+    void RemoveRegion(int id);
+    void ClearRegions();
+    void Close();
+
+  private:
+    void Run();
+    void Process(const struct input_event &ev);
+    void Report(double time);
+    void FlushRelease();
+    void Emit(TouchEventType type, int x, int y, double time);
+    void Map(int rawX, int rawY, int *x, int *y);
+    int HitTest(int x, int y);
+    static double Now();
+
+    int fd;
+    int wakeFd;
+    int epfd;
+    // regular files (recorded streams) cannot be polled and are read straight through
+    bool replay;
+
+    std::thread thread;
+    std::atomic<bool> running;
+
+    std::mutex regionLock;
+    std::vector<TouchRegion> regions;
+
+    TouchCalibration cal;
+    double debounceMs;
+    int moveThreshold;
+    bool regionsOnly;
+
+    // state decoded from the event stream, only touched by the reader thread
+    int rawX, rawY;
+    int slot;
+    bool contact;
+    bool pressed;
+    bool releasePending;
+    double releaseTime;
+    int lastX, lastY;
+    int pressRegion;
+
+    std::function<void(const TouchEvent &)> onEvent;
+    std::function<void()> onEnd;
+};
+
+#endif
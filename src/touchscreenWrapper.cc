@@ -0,0 +1,171 @@
+#include "touchscreenWrapper.h"
+#include "options.h"
+
+Napi::FunctionReference TouchScreenWrapper::constructor;
+
+Napi::Object TouchScreenWrapper::Init(Napi::Env env, Napi::Object exports) {
+    Napi::HandleScope scope(env);
+
+    Napi::Function func = DefineClass(
+        env, "TouchScreenWrapper",
+        // clang-format off
+        {InstanceMethod("addRegion", &TouchScreenWrapper::AddRegion),
+         InstanceMethod("removeRegion", &TouchScreenWrapper::RemoveRegion),
+         InstanceMethod("clearRegions", &TouchScreenWrapper::ClearRegions),
+         InstanceMethod("close", &TouchScreenWrapper::Close)});
+    // clang-format on
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("TouchScreen", func);
+
+    return exports;
+}
+
+TouchScreenWrapper::TouchScreenWrapper(const Napi::CallbackInfo &info) : Napi::ObjectWrap<TouchScreenWrapper>(info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    this->touchScreenClass_ = nullptr;
+    this->released_ = true;
+
+    if (info.Length() < 3 || !info[0].IsString() || !info[1].IsObject() || !info[2].IsFunction()) {
+        Napi::TypeError::New(env, "expected device path, options and callback").ThrowAsJavaScriptException();
+        return;
+    }
+
+    // input device path, a recorded event file or a pipe
+    std::string path = info[0].As<Napi::String>().Utf8Value();
+    Napi::Object options = info[1].As<Napi::Object>();
+
+    TouchCalibration cal;
+    cal.minX = OptionNumber(options, "minX", -1);
+    cal.maxX = OptionNumber(options, "maxX", -1);
+    cal.minY = OptionNumber(options, "minY", -1);
+    cal.maxY = OptionNumber(options, "maxY", -1);
+    cal.width = OptionNumber(options, "width", 0);
+    cal.height = OptionNumber(options, "height", 0);
+    cal.rotate = OptionNumber(options, "rotate", 0);
+    cal.swapXY = OptionBoolean(options, "swapXY", false);
+    cal.invertX = OptionBoolean(options, "invertX", false);
+    cal.invertY = OptionBoolean(options, "invertY", false);
+
+    double debounce = OptionNumber(options, "debounce", 20);
+    int moveThreshold = OptionNumber(options, "moveThreshold", 2);
+    bool regionsOnly = OptionBoolean(options, "regionsOnly", false);
+
+    this->callback_ =
+        Napi::ThreadSafeFunction::New(env, info[2].As<Napi::Function>(), "pitft touchscreen", 0, 1);
+    this->released_ = false;
+
+    Napi::ThreadSafeFunction tsfn = this->callback_;
+
+    auto onEvent = [tsfn](const TouchEvent &event) {
+        TouchEvent *copy = new TouchEvent(event);
+
+        napi_status status = tsfn.BlockingCall(copy, [](Napi::Env env, Napi::Function jsCallback, TouchEvent *e) {
+            Napi::Object eventObject = Napi::Object::New(env);
+            const char *type = e->type == TOUCH_DOWN ? "down" : (e->type == TOUCH_MOVE ? "move" : "up");
+
+            eventObject.Set("type", type);
+            eventObject.Set("x", e->x);
+            eventObject.Set("y", e->y);
+            eventObject.Set("region", e->region == -1 ? env.Null() : Napi::Number::New(env, e->region));
+            eventObject.Set("pressRegion",
+                            e->pressRegion == -1 ? env.Null() : Napi::Number::New(env, e->pressRegion));
+            eventObject.Set("time", e->time);
+
+            delete e;
+
+            jsCallback.Call({eventObject});
+        });
+
+        if (status != napi_ok)
+            delete copy;
+    };
+
+    // the reader stops on its own at the end of a recorded stream, let the event loop exit then
+    auto onEnd = [this]() { this->Release(); };
+
+    try {
+        this->touchScreenClass_ =
+            new TouchScreen(path.c_str(), cal, debounce, moveThreshold, regionsOnly, onEvent, onEnd);
+    } catch (const std::exception &e) {
+        this->Release();
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+}
+
+void TouchScreenWrapper::AddRegion(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    if (this->touchScreenClass_ == nullptr)
+        return;
+
+    if (info[0].IsNumber() && info[1].IsNumber() && info[2].IsNumber() && info[3].IsNumber() && info[4].IsNumber())
+        // clang-format off
+        this->touchScreenClass_->AddRegion(
+            info[0].As<Napi::Number>().Int32Value(),
+            info[1].As<Napi::Number>().DoubleValue(),
+            info[2].As<Napi::Number>().DoubleValue(),
+            info[3].As<Napi::Number>().DoubleValue(),
+            info[4].As<Napi::Number>().DoubleValue());
+    // clang-format on
+    else
+        Napi::TypeError::New(env, "invalid argument").ThrowAsJavaScriptException();
+
+    return;
+}
+
+void TouchScreenWrapper::RemoveRegion(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    if (this->touchScreenClass_ == nullptr)
+        return;
+
+    if (info.Length() == 1 && info[0].IsNumber())
+        this->touchScreenClass_->RemoveRegion(info[0].As<Napi::Number>().Int32Value());
+    else
+        Napi::TypeError::New(env, "invalid argument").ThrowAsJavaScriptException();
+
+    return;
+}
+
+void TouchScreenWrapper::ClearRegions(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    if (this->touchScreenClass_ != nullptr)
+        this->touchScreenClass_->ClearRegions();
+
+    return;
+}
+
+void TouchScreenWrapper::Close(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    if (this->touchScreenClass_ != nullptr)
+        this->touchScreenClass_->Close();
+
+    this->Release();
+
+    return;
+}
+
+void TouchScreenWrapper::Release() {
+    if (!this->released_.exchange(true))
+        this->callback_.Release();
+
+    return;
+}
+
+TouchScreenWrapper::~TouchScreenWrapper() {
+    if (this->touchScreenClass_ != nullptr)
+        delete this->touchScreenClass_;
+
+    this->Release();
+}
@@ -0,0 +1,29 @@
+#ifndef TOUCHSCREENWRAPPER_H
+#define TOUCHSCREENWRAPPER_H
+
+#include "touchscreen.h"
+#include <atomic>
+#include <napi.h>
+
+class TouchScreenWrapper : public Napi::ObjectWrap<TouchScreenWrapper> {
+  public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    TouchScreenWrapper(const Napi::CallbackInfo &info);
+    ~TouchScreenWrapper();
+
+  private:
+    static Napi::FunctionReference constructor;
+
+    void AddRegion(const Napi::CallbackInfo &info);
+    void RemoveRegion(const Napi::CallbackInfo &info);
+    void ClearRegions(const Napi::CallbackInfo &info);
+    void Close(const Napi::CallbackInfo &info);
+
+    void Release();
+
+    TouchScreen *touchScreenClass_;
+    Napi::ThreadSafeFunction callback_;
+    std::atomic<bool> released_;
+};
+
+#endif
@@ -0,0 +1,43 @@
+#!/usr/bin/env node
+// Packs PNG images into a pre-converted RGB565 asset pack for fb.assetPack().
+//
+//   pack-assets [--rle] [--base <dir>] <output.pak> <image.png>...
+//
+// Images are named by their path relative to the base directory (the current directory by default), which is
+// the name fb.image() is called with.
+
+var path = require("path");
+var pitft = require("../pitft-napi");
+
+var args = process.argv.slice(2);
+var rle = false;
+var base = process.cwd();
+
+while (args.length && args[0].indexOf("--") === 0) {
+    var option = args.shift();
+
+    if (option === "--rle")
+        rle = true;
+    else if (option === "--base")
+        base = path.resolve(args.shift());
+    else {
+        console.error("unknown option " + option);
+        process.exit(1);
+    }
+}
+
+if (args.length < 2) {
+    console.error("usage: pack-assets [--rle] [--base <dir>] <output.pak> <image.png>...");
+    process.exit(1);
+}
+
+var output = args.shift();
+var images = {};
+
+args.forEach(function (image) {
+    images[path.relative(base, path.resolve(image))] = image;
+});
+
+pitft.packAssets(output, images, { rle: rle });
+
+console.log("packed " + args.length + " images into " + output);